@@ -819,6 +819,7 @@ local WEBCORE_SRC_FILES = {
     "WebCore/platform/cf/KURLCFNet.cpp",
     "WebCore/platform/cf/SharedBufferCF.cpp",
     "WebCore/platform/cf/win/CertificateCFWin.cpp",
+    "WebCore/platform/graphics/AsyncImageDecoder.cpp",
     "WebCore/platform/graphics/BitmapImage.cpp",
     "WebCore/platform/graphics/Color.cpp",
     "WebCore/platform/graphics/ContextShadow.cpp",
@@ -966,6 +967,8 @@ local WEBCORE_SRC_FILES = {
     "WebCore/platform/network/win/NetworkStateNotifierWin.cpp",
     "WebCore/platform/network/curl/CookieJarCurl.cpp",
     "WebCore/platform/network/curl/CredentialStorageCurl.cpp",
+    "WebCore/platform/network/curl/CurlCacheEntry.cpp",
+    "WebCore/platform/network/curl/CurlCacheManager.cpp",
     "WebCore/platform/network/curl/DNSCurl.cpp",
     "WebCore/platform/network/curl/FormDataStreamCurl.cpp",
     "WebCore/platform/network/curl/ProxyServerCurl.cpp",
@@ -1004,6 +1007,7 @@ local WEBCORE_SRC_FILES = {
     "WebCore/platform/text/TextEncodingRegistry.cpp",
     "WebCore/platform/text/TextStream.cpp",
     "WebCore/platform/text/UnicodeRange.cpp",
+    "WebCore/platform/graphics/WidthCache.cpp",
     "WebCore/platform/graphics/WidthIterator.cpp",
     "WebCore/platform/text/cf/HyphenationCF.cpp",
     "WebCore/platform/text/cf/StringCF.cpp",
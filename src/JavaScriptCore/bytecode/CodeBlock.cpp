@@ -41,6 +41,7 @@
 #include "JSStaticScopeObject.h"
 #include "JSValue.h"
 #include "RepatchBuffer.h"
+#include "SamplingProfiler.h"
 #include "UStringConcatenate.h"
 #include <stdio.h>
 #include <wtf/StringExtras.h>
@@ -1441,6 +1442,11 @@ CodeBlock::CodeBlock(ScriptExecutable* ownerExecutable, CodeType codeType, JSGlo
 #if DUMP_CODE_BLOCK_STATISTICS
     liveCodeBlockSet.add(this);
 #endif
+
+#if ENABLE(SAMPLING_PROFILER)
+    if (m_heap->globalData()->samplingProfiler->isRunning())
+        m_heap->globalData()->samplingProfiler->didCreateCodeBlock(this);
+#endif
 }
 
 CodeBlock::~CodeBlock()
@@ -1470,6 +1476,11 @@ CodeBlock::~CodeBlock()
 #if DUMP_CODE_BLOCK_STATISTICS
     liveCodeBlockSet.remove(this);
 #endif
+
+#if ENABLE(SAMPLING_PROFILER)
+    if (m_heap->globalData()->samplingProfiler->isRunning())
+        m_heap->globalData()->samplingProfiler->willDestroyCodeBlock(this);
+#endif
 }
 
 void CodeBlock::visitStructures(SlotVisitor& visitor, Instruction* vPC) const
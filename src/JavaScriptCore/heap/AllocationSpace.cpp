@@ -28,6 +28,7 @@
 #include "AllocationSpace.h"
 
 #include "Heap.h"
+#include <wtf/CurrentTime.h>
 
 #define COLLECT_ON_EVERY_ALLOCATION 0
 
@@ -168,6 +169,27 @@ void AllocationSpace::shrink()
     freeBlocks(forEachBlock(takeIfUnmarked));
 }
 
+void AllocationSpace::startIncrementalSweep()
+{
+    copyToVector(m_blocks.set(), m_blocksToSweep);
+}
+
+bool AllocationSpace::sweepIncrementally(double deadline)
+{
+    while (!m_blocksToSweep.isEmpty()) {
+        MarkedBlock* block = m_blocksToSweep.last();
+        m_blocksToSweep.removeLast();
+
+        // The allocator may have swept the block since the snapshot was taken.
+        if (block->needsSweeping())
+            block->sweep();
+
+        if (currentTime() >= deadline)
+            break;
+    }
+    return !m_blocksToSweep.isEmpty();
+}
+
 #if ENABLE(GGC)
 class GatherDirtyCells {
     WTF_MAKE_NONCOPYABLE(GatherDirtyCells);
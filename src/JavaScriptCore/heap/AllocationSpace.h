@@ -30,6 +30,7 @@
 #include "MarkedSpace.h"
 
 #include <wtf/HashSet.h>
+#include <wtf/Vector.h>
 
 namespace JSC {
 
@@ -66,6 +67,11 @@ public:
     void* allocate(size_t);
     void freeBlocks(MarkedBlock*);
     void shrink();
+
+    void startIncrementalSweep();
+    void stopIncrementalSweep() { m_blocksToSweep.clear(); }
+    bool hasBlocksToSweep() const { return !m_blocksToSweep.isEmpty(); }
+    bool sweepIncrementally(double deadline);
     
 private:
     enum AllocationEffort { AllocationMustSucceed, AllocationCanFail };
@@ -78,6 +84,7 @@ private:
     Heap* m_heap;
     MarkedSpace m_markedSpace;
     MarkedBlockSet m_blocks;
+    Vector<MarkedBlock*> m_blocksToSweep;
 };
 
 template<typename Functor> inline typename Functor::ReturnType AllocationSpace::forEachCell(Functor& functor)
@@ -209,15 +209,6 @@ inline void ClearMarks::operator()(MarkedBlock* block)
     block->clearMarks();
 }
 
-struct Sweep : MarkedBlock::VoidFunctor {
-    void operator()(MarkedBlock*);
-};
-
-inline void Sweep::operator()(MarkedBlock* block)
-{
-    block->sweep();
-}
-
 struct MarkCount : CountFunctor {
     void operator()(MarkedBlock*);
 };
@@ -315,9 +306,11 @@ Heap::Heap(JSGlobalData* globalData, HeapSize heapSize)
     , m_markListSet(0)
     , m_activityCallback(DefaultGCActivityCallback::create(this))
     , m_machineThreads(this)
-    , m_slotVisitor(globalData->jsArrayVPtr, globalData->jsFinalObjectVPtr, globalData->jsStringVPtr)
+    , m_sharedData(globalData->jsArrayVPtr, globalData->jsFinalObjectVPtr, globalData->jsStringVPtr)
+    , m_slotVisitor(m_sharedData)
     , m_handleHeap(globalData)
     , m_isSafeToCollect(false)
+    , m_lastMarkingTime(0)
     , m_globalData(globalData)
 {
     m_objectSpace.setHighWaterMark(m_minBytesPerCycle);
@@ -363,6 +356,7 @@ void Heap::destroy()
     m_markListSet = 0;
 
     canonicalizeCellLivenessData();
+    m_objectSpace.stopIncrementalSweep();
     clearMarks();
 
     m_handleHeap.finalizeWeakHandles();
@@ -557,6 +551,7 @@ void Heap::markRoots(bool fullGC)
         CRASH();
     m_operationInProgress = Collection;
 
+    double markingStartTime = currentTime();
     void* dummy;
     
     // We gather conservative roots before clearing mark bits because conservative
@@ -604,53 +599,59 @@ void Heap::markRoots(bool fullGC)
     {
         GCPHASE(VisitMachineRoots);
         visitor.append(machineThreadRoots);
-        visitor.drain();
+        visitor.donateAndDrain();
     }
     {
         GCPHASE(VisitRegisterFileRoots);
         visitor.append(registerFileRoots);
-        visitor.drain();
+        visitor.donateAndDrain();
     }
     {
         GCPHASE(VisitProtectedObjects);
         markProtectedObjects(heapRootVisitor);
-        visitor.drain();
+        visitor.donateAndDrain();
     }
     {
         GCPHASE(VisitTempSortVectors);
         markTempSortVectors(heapRootVisitor);
-        visitor.drain();
+        visitor.donateAndDrain();
     }
 
     {
         GCPHASE(MarkingArgumentBuffers);
         if (m_markListSet && m_markListSet->size()) {
             MarkedArgumentBuffer::markLists(heapRootVisitor, *m_markListSet);
-            visitor.drain();
+            visitor.donateAndDrain();
         }
     }
     if (m_globalData->exception) {
         GCPHASE(MarkingException);
         heapRootVisitor.visit(&m_globalData->exception);
-        visitor.drain();
+        visitor.donateAndDrain();
     }
     
     {
         GCPHASE(VisitStrongHandles);
         m_handleHeap.visitStrongHandles(heapRootVisitor);
-        visitor.drain();
+        visitor.donateAndDrain();
     }
     
     {
         GCPHASE(HandleStack);
         m_handleStack.visit(heapRootVisitor);
-        visitor.drain();
+        visitor.donateAndDrain();
     }
     
     {
         GCPHASE(TraceCodeBlocks);
         m_jettisonedCodeBlocks.traceCodeBlocks(visitor);
-        visitor.drain();
+        visitor.donateAndDrain();
+    }
+
+    // Helper threads may still be marking; wait for every marker to run dry.
+    {
+        GCPHASE(Convergence);
+        visitor.drainFromShared(SlotVisitor::MasterDrain);
     }
 
     // Weak handles must be marked last, because their owners use the set of
@@ -661,12 +662,21 @@ void Heap::markRoots(bool fullGC)
         do {
             lastOpaqueRootCount = visitor.opaqueRootCount();
             m_handleHeap.visitWeakHandles(heapRootVisitor);
-            visitor.drain();
+            visitor.donateAndDrain();
+            visitor.drainFromShared(SlotVisitor::MasterDrain);
             // If the set of opaque roots has grown, more weak handles may have become reachable.
         } while (lastOpaqueRootCount != visitor.opaqueRootCount());
     }
-    GCCOUNTER(VisitedValueCount, visitor.visitCount());
+    m_sharedData.copyVisitCounts(m_lastMarkingVisitCounts);
+#if ENABLE(GC_LOGGING)
+    size_t visitCount = 0;
+    for (size_t i = 0; i < m_lastMarkingVisitCounts.size(); ++i)
+        visitCount += m_lastMarkingVisitCounts[i];
+    GCCOUNTER(VisitedValueCount, visitCount);
+#endif
     visitor.reset();
+    m_sharedData.reset();
+    m_lastMarkingTime = currentTime() - markingStartTime;
 
     m_operationInProgress = NoOperation;
 }
@@ -676,9 +686,11 @@ void Heap::clearMarks()
     m_objectSpace.forEachBlock<ClearMarks>();
 }
 
-void Heap::sweep()
+bool Heap::sweepIncrementally(double timeLimit)
 {
-    m_objectSpace.forEachBlock<Sweep>();
+    if (isBusy())
+        return m_objectSpace.hasBlocksToSweep();
+    return m_objectSpace.sweepIncrementally(currentTime() + timeLimit);
 }
 
 size_t Heap::objectCount()
@@ -765,11 +777,14 @@ void Heap::collect(SweepToggle sweepToggle)
         resetAllocator();
     }
 
+    // Blocks are swept lazily, by the allocator as it needs free cells or by
+    // the activity callback when the thread goes idle. Only empty blocks are
+    // released here, since they have to go before the allocator reuses them.
     if (sweepToggle == DoSweep) {
-        GCPHASE(Sweeping);
-        sweep();
+        GCPHASE(Shrink);
         shrink();
     }
+    m_objectSpace.startIncrementalSweep();
 
     // To avoid pathological GC churn in large heaps, we set the allocation high
     // water mark to be proportional to the current size of the heap. The exact
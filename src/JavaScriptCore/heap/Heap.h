@@ -98,6 +98,10 @@ namespace JSC {
         void notifyIsSafeToCollect() { m_isSafeToCollect = true; }
         void collectAllGarbage();
 
+        // Sweeps blocks the last collection left unswept for about timeLimit
+        // seconds. Returns true if some remain.
+        bool sweepIncrementally(double timeLimit);
+
         void reportExtraMemoryCost(size_t cost);
 
         void protect(JSValue);
@@ -127,6 +131,11 @@ namespace JSC {
 
         void getConservativeRegisterRoots(HashSet<JSCell*>& roots);
 
+        // Wall time of the last mark phase in seconds, and the slots each
+        // marking thread visited during it. Index 0 is the collecting thread.
+        double lastMarkingTime() const { return m_lastMarkingTime; }
+        const Vector<size_t>& lastMarkingVisitCounts() const { return m_lastMarkingVisitCounts; }
+
     private:
         friend class MarkedBlock;
         friend class AllocationSpace;
@@ -159,7 +168,6 @@ namespace JSC {
         void collect(SweepToggle);
         void shrink();
         void releaseFreeBlocks();
-        void sweep();
 
         RegisterFile& registerFile();
 
@@ -196,6 +204,7 @@ namespace JSC {
         OwnPtr<GCActivityCallback> m_activityCallback;
         
         MachineThreads m_machineThreads;
+        MarkStackThreadSharedData m_sharedData;
         SlotVisitor m_slotVisitor;
         HandleHeap m_handleHeap;
         HandleStack m_handleStack;
@@ -204,6 +213,9 @@ namespace JSC {
         
         bool m_isSafeToCollect;
 
+        double m_lastMarkingTime;
+        Vector<size_t> m_lastMarkingVisitCounts;
+
         JSGlobalData* m_globalData;
     };
 
@@ -34,9 +34,20 @@
 #include "ScopeChain.h"
 #include "Structure.h"
 #include "WriteBarrier.h"
+#include <algorithm>
+#include <wtf/NumberOfCores.h>
 
 namespace JSC {
 
+// More markers than this rarely pay for the extra contention on the shared stack.
+static const unsigned maximumNumberOfMarkers = 4;
+
+// How many cells a marker scans before it offers work to idle markers again.
+static const unsigned numberOfScansBetweenDonations = 100;
+
+// A marker never donates its last few cells, so that it can keep going.
+static const size_t minimumNumberOfCellsToKeep = 10;
+
 MarkStackArray::MarkStackArray()
     : m_top(0)
     , m_allocated(pageSize())
@@ -61,6 +72,29 @@ void MarkStackArray::expand()
     m_data = static_cast<const JSCell**>(newData);
 }
 
+void MarkStackArray::donateSomeCellsTo(MarkStackArray& other)
+{
+    if (m_top <= minimumNumberOfCellsToKeep)
+        return;
+
+    // The bottom of the stack holds cells found closest to the roots, which
+    // tend to lead to the largest unexplored subgraphs.
+    size_t count = m_top / 2;
+    for (size_t i = 0; i < count; ++i)
+        other.append(m_data[i]);
+    memmove(m_data, m_data + count, (m_top - count) * sizeof(JSCell*));
+    m_top -= count;
+}
+
+void MarkStackArray::stealSomeCellsFrom(MarkStackArray& other, size_t idleThreadCount)
+{
+    ASSERT(idleThreadCount);
+    // Round up so that a lone idle thread takes everything.
+    size_t numberOfCellsToSteal = (other.size() + idleThreadCount - 1) / idleThreadCount;
+    while (numberOfCellsToSteal-- > 0 && !other.isEmpty())
+        append(other.removeLast());
+}
+
 void MarkStackArray::shrinkAllocation(size_t size)
 {
     ASSERT(size <= m_allocated);
@@ -79,10 +113,104 @@ void MarkStackArray::shrinkAllocation(size_t size)
     m_capacity = m_allocated / sizeof(JSCell*);
 }
 
+static unsigned computeNumberOfMarkers()
+{
+#if ENABLE(PARALLEL_GC)
+    return std::min<unsigned>(numberOfProcessorCores(), maximumNumberOfMarkers);
+#else
+    return 1;
+#endif
+}
+
+MarkStackThreadSharedData::MarkStackThreadSharedData(void* jsArrayVPtr, void* jsFinalObjectVPtr, void* jsStringVPtr)
+    : m_jsArrayVPtr(jsArrayVPtr)
+    , m_jsFinalObjectVPtr(jsFinalObjectVPtr)
+    , m_jsStringVPtr(jsStringVPtr)
+    , m_numberOfMarkers(computeNumberOfMarkers())
+    , m_nextMarkerIndex(1)
+    , m_numberOfActiveParallelMarkers(0)
+    , m_parallelMarkersShouldExit(false)
+    , m_visitCounts(m_numberOfMarkers)
+    , m_firstWeakReferenceHarvester(0)
+{
+    m_visitCounts.fill(0);
+#if ENABLE(PARALLEL_GC)
+    for (unsigned i = 1; i < m_numberOfMarkers; ++i) {
+        ThreadIdentifier thread = createThread(markingThreadStartFunc, this, "JavaScriptCore::Marking");
+        ASSERT(thread);
+        m_markingThreads.append(thread);
+    }
+#endif
+}
+
+MarkStackThreadSharedData::~MarkStackThreadSharedData()
+{
+#if ENABLE(PARALLEL_GC)
+    // Destroy our marking threads.
+    {
+        MutexLocker locker(m_markingLock);
+        m_parallelMarkersShouldExit = true;
+        m_markingCondition.broadcast();
+    }
+    for (unsigned i = 0; i < m_markingThreads.size(); ++i)
+        waitForThreadCompletion(m_markingThreads[i], 0);
+#endif
+}
+
+#if ENABLE(PARALLEL_GC)
+void* MarkStackThreadSharedData::markingThreadStartFunc(void* shared)
+{
+    static_cast<MarkStackThreadSharedData*>(shared)->markingThreadMain();
+    return 0;
+}
+
+void MarkStackThreadSharedData::markingThreadMain()
+{
+    unsigned markerIndex;
+    {
+        MutexLocker locker(m_markingLock);
+        markerIndex = m_nextMarkerIndex++;
+    }
+    SlotVisitor slotVisitor(*this, markerIndex);
+    slotVisitor.drainFromShared(SlotVisitor::SlaveDrain);
+}
+#endif
+
+void MarkStackThreadSharedData::reset()
+{
+    ASSERT(!m_numberOfActiveParallelMarkers);
+    ASSERT(m_sharedMarkStack.isEmpty());
+    m_sharedMarkStack.shrinkAllocation(pageSize());
+    m_opaqueRoots.clear();
+
+    MutexLocker locker(m_markingLock);
+    m_visitCounts.fill(0);
+}
+
+void MarkStackThreadSharedData::copyVisitCounts(Vector<size_t>& visitCounts)
+{
+    MutexLocker locker(m_markingLock);
+    visitCounts = m_visitCounts;
+}
+
 void MarkStack::reset()
 {
     m_visitCount = 0;
     m_stack.shrinkAllocation(pageSize());
+    ASSERT(m_opaqueRoots.isEmpty());
+    m_opaqueRoots.clear();
+}
+
+void MarkStack::mergeOpaqueRoots()
+{
+    if (m_opaqueRoots.isEmpty())
+        return;
+    {
+        MutexLocker locker(m_shared.m_opaqueRootsLock);
+        HashSet<void*>::iterator end = m_opaqueRoots.end();
+        for (HashSet<void*>::iterator iter = m_opaqueRoots.begin(); iter != end; ++iter)
+            m_shared.m_opaqueRoots.add(*iter);
+    }
     m_opaqueRoots.clear();
 }
 
@@ -120,23 +248,126 @@ ALWAYS_INLINE static void visitChildren(SlotVisitor& visitor, const JSCell* cell
     cell->methodTable()->visitChildren(const_cast<JSCell*>(cell), visitor);
 }
 
+void SlotVisitor::donateKnownParallel()
+{
+    // We retry often, so it is fine to be conservative and skip donating
+    // whenever it looks unprofitable.
+
+    // Avoid locking when a thread reaches a dead end in the object graph.
+    if (m_stack.size() < 2)
+        return;
+
+    // If there is already shared work queued up, assume donating more does not help.
+    if (m_shared.m_sharedMarkStack.size())
+        return;
+
+    // If another thread holds the lock, assume it is already donating.
+    if (!m_shared.m_markingLock.tryLock())
+        return;
+
+    m_stack.donateSomeCellsTo(m_shared.m_sharedMarkStack);
+    if (m_shared.m_numberOfActiveParallelMarkers < m_shared.m_numberOfMarkers)
+        m_shared.m_markingCondition.broadcast();
+
+    m_shared.m_markingLock.unlock();
+}
+
 void SlotVisitor::drain()
 {
     void* jsFinalObjectVPtr = m_jsFinalObjectVPtr;
     void* jsArrayVPtr = m_jsArrayVPtr;
     void* jsStringVPtr = m_jsStringVPtr;
 
+#if ENABLE(PARALLEL_GC)
+    if (m_shared.m_numberOfMarkers > 1) {
+        while (!m_stack.isEmpty()) {
+            for (unsigned countdown = numberOfScansBetweenDonations; !m_stack.isEmpty() && countdown--;)
+                visitChildren(*this, m_stack.removeLast(), jsFinalObjectVPtr, jsArrayVPtr, jsStringVPtr);
+            donateKnownParallel();
+        }
+        mergeOpaqueRoots();
+        return;
+    }
+#endif
+
     while (!m_stack.isEmpty())
         visitChildren(*this, m_stack.removeLast(), jsFinalObjectVPtr, jsArrayVPtr, jsStringVPtr);
 }
 
+void SlotVisitor::publishVisitCountWhileHoldingLock()
+{
+    m_shared.m_visitCounts[m_markerIndex] += m_visitCount;
+    m_visitCount = 0;
+}
+
+void SlotVisitor::drainFromShared(SharedDrainMode sharedDrainMode)
+{
+    if (m_shared.m_numberOfMarkers == 1) {
+        // There is nobody to share with, so this call is a no-op.
+        ASSERT_UNUSED(sharedDrainMode, sharedDrainMode == MasterDrain);
+        ASSERT(m_stack.isEmpty());
+        ASSERT(m_shared.m_sharedMarkStack.isEmpty());
+        MutexLocker locker(m_shared.m_markingLock);
+        publishVisitCountWhileHoldingLock();
+        return;
+    }
+
+    {
+        MutexLocker locker(m_shared.m_markingLock);
+        m_shared.m_numberOfActiveParallelMarkers++;
+    }
+    while (true) {
+        {
+            MutexLocker locker(m_shared.m_markingLock);
+            publishVisitCountWhileHoldingLock();
+            m_shared.m_numberOfActiveParallelMarkers--;
+
+            // How we wait differs depending on drain mode.
+            if (sharedDrainMode == MasterDrain) {
+                // Wait until either termination is reached, or until there is some work for us to do.
+                while (true) {
+                    // Did we reach termination?
+                    if (!m_shared.m_numberOfActiveParallelMarkers && m_shared.m_sharedMarkStack.isEmpty())
+                        return;
+
+                    // Is there work to be done?
+                    if (!m_shared.m_sharedMarkStack.isEmpty())
+                        break;
+
+                    // Otherwise wait.
+                    m_shared.m_markingCondition.wait(m_shared.m_markingLock);
+                }
+            } else {
+                ASSERT(sharedDrainMode == SlaveDrain);
+
+                // Did we detect termination? If so, let the master know.
+                if (!m_shared.m_numberOfActiveParallelMarkers && m_shared.m_sharedMarkStack.isEmpty())
+                    m_shared.m_markingCondition.broadcast();
+
+                while (m_shared.m_sharedMarkStack.isEmpty() && !m_shared.m_parallelMarkersShouldExit)
+                    m_shared.m_markingCondition.wait(m_shared.m_markingLock);
+
+                // Is the heap going away? If so, exit this thread.
+                if (m_shared.m_parallelMarkersShouldExit)
+                    return;
+            }
+
+            size_t idleThreadCount = m_shared.m_numberOfMarkers - m_shared.m_numberOfActiveParallelMarkers;
+            m_stack.stealSomeCellsFrom(m_shared.m_sharedMarkStack, idleThreadCount);
+            m_shared.m_numberOfActiveParallelMarkers++;
+        }
+
+        drain();
+    }
+}
+
 void SlotVisitor::harvestWeakReferences()
 {
-    while (m_firstWeakReferenceHarvester) {
-        WeakReferenceHarvester* current = m_firstWeakReferenceHarvester;
+    while (m_shared.m_firstWeakReferenceHarvester) {
+        WeakReferenceHarvester* current = m_shared.m_firstWeakReferenceHarvester;
         WeakReferenceHarvester* next = reinterpret_cast<WeakReferenceHarvester*>(current->m_nextAndFlag & ~1);
         current->m_nextAndFlag = 0;
-        m_firstWeakReferenceHarvester = next;
+        m_shared.m_firstWeakReferenceHarvester = next;
         current->visitWeakReferences(*this);
     }
 }
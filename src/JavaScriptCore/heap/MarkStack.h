@@ -37,6 +37,7 @@
 #include <wtf/Noncopyable.h>
 #include <wtf/OSAllocator.h>
 #include <wtf/PageBlock.h>
+#include <wtf/Threading.h>
 
 namespace JSC {
 
@@ -44,6 +45,7 @@ namespace JSC {
     class JSGlobalData;
     class MarkStack;
     class Register;
+    class SlotVisitor;
     template<typename T> class WriteBarrierBase;
     template<typename T> class JITWriteBarrier;
     
@@ -58,6 +60,12 @@ namespace JSC {
         const JSCell* removeLast();
 
         bool isEmpty();
+        size_t size() const { return m_top; }
+
+        // Hands the bottom half of this stack to another one.
+        void donateSomeCellsTo(MarkStackArray& other);
+        // Takes a share of another stack's cells, sized for the idle threads.
+        void stealSomeCellsFrom(MarkStackArray& other, size_t idleThreadCount);
 
         void shrinkAllocation(size_t);
 
@@ -68,6 +76,54 @@ namespace JSC {
         size_t m_allocated;
     };
 
+    // State shared by every SlotVisitor of a heap: the mark stack that idle
+    // markers steal from, the merged opaque roots and the helper threads.
+    class MarkStackThreadSharedData {
+        WTF_MAKE_NONCOPYABLE(MarkStackThreadSharedData);
+    public:
+        MarkStackThreadSharedData(void* jsArrayVPtr, void* jsFinalObjectVPtr, void* jsStringVPtr);
+        ~MarkStackThreadSharedData();
+
+        void reset();
+
+        // Threads that drain the mark stack, the collecting thread included.
+        unsigned numberOfMarkers() const { return m_numberOfMarkers; }
+
+        // Slots each marker visited since the last reset(). Index 0 is the
+        // collecting thread.
+        void copyVisitCounts(Vector<size_t>&);
+
+    private:
+        friend class MarkStack;
+        friend class SlotVisitor;
+
+#if ENABLE(PARALLEL_GC)
+        void markingThreadMain();
+        static void* markingThreadStartFunc(void* sharedData);
+#endif
+
+        void* m_jsArrayVPtr;
+        void* m_jsFinalObjectVPtr;
+        void* m_jsStringVPtr;
+        const unsigned m_numberOfMarkers;
+
+        Vector<ThreadIdentifier> m_markingThreads;
+        unsigned m_nextMarkerIndex;
+
+        Mutex m_markingLock;
+        ThreadCondition m_markingCondition;
+        MarkStackArray m_sharedMarkStack;
+        unsigned m_numberOfActiveParallelMarkers;
+        bool m_parallelMarkersShouldExit;
+        Vector<size_t> m_visitCounts;
+
+        Mutex m_opaqueRootsLock;
+        HashSet<void*> m_opaqueRoots; // Handle-owning data structures not visible to the garbage collector.
+
+        Mutex m_weakReferenceHarvesterLock;
+        WeakReferenceHarvester* m_firstWeakReferenceHarvester;
+    };
+
     class MarkStack {
         WTF_MAKE_NONCOPYABLE(MarkStack);
         friend class HeapRootVisitor; // Allowed to mark a JSValue* or JSCell** directly.
@@ -76,7 +132,7 @@ namespace JSC {
         static void* allocateStack(size_t);
         static void releaseStack(void*, size_t);
 
-        MarkStack(void* jsArrayVPtr, void* jsFinalObjectVPtr, void* jsStringVPtr);
+        MarkStack(MarkStackThreadSharedData&, unsigned markerIndex);
         ~MarkStack();
 
         void append(ConservativeRoots&);
@@ -88,10 +144,12 @@ namespace JSC {
         template<typename T>
         void appendUnbarrieredPointer(T**);
         
-        bool addOpaqueRoot(void*);
+        void addOpaqueRoot(void*);
         bool containsOpaqueRoot(void*);
         int opaqueRootCount();
 
+        bool isEmpty() { return m_stack.isEmpty(); }
+
         void reset();
 
         size_t visitCount() const { return m_visitCount; }
@@ -102,15 +160,18 @@ namespace JSC {
 
         void addWeakReferenceHarvester(WeakReferenceHarvester* weakReferenceHarvester)
         {
+            MutexLocker locker(m_shared.m_weakReferenceHarvesterLock);
             if (weakReferenceHarvester->m_nextAndFlag & 1)
                 return;
-            weakReferenceHarvester->m_nextAndFlag = reinterpret_cast<uintptr_t>(m_firstWeakReferenceHarvester) | 1;
-            m_firstWeakReferenceHarvester = weakReferenceHarvester;
+            weakReferenceHarvester->m_nextAndFlag = reinterpret_cast<uintptr_t>(m_shared.m_firstWeakReferenceHarvester) | 1;
+            m_shared.m_firstWeakReferenceHarvester = weakReferenceHarvester;
         }
 
     protected:
         static void validate(JSCell*);
 
+        void mergeOpaqueRoots();
+
         void append(JSValue*);
         void append(JSValue*, size_t count);
         void append(JSCell**);
@@ -122,8 +183,10 @@ namespace JSC {
         void* m_jsArrayVPtr;
         void* m_jsFinalObjectVPtr;
         void* m_jsStringVPtr;
-        HashSet<void*> m_opaqueRoots; // Handle-owning data structures not visible to the garbage collector.
-        WeakReferenceHarvester* m_firstWeakReferenceHarvester;
+        HashSet<void*> m_opaqueRoots; // Roots found by this marker and not yet merged into the shared set.
+
+        MarkStackThreadSharedData& m_shared;
+        unsigned m_markerIndex;
         
 #if !ASSERT_DISABLED
     public:
@@ -134,11 +197,12 @@ namespace JSC {
         size_t m_visitCount;
     };
 
-    inline MarkStack::MarkStack(void* jsArrayVPtr, void* jsFinalObjectVPtr, void* jsStringVPtr)
-        : m_jsArrayVPtr(jsArrayVPtr)
-        , m_jsFinalObjectVPtr(jsFinalObjectVPtr)
-        , m_jsStringVPtr(jsStringVPtr)
-        , m_firstWeakReferenceHarvester(0)
+    inline MarkStack::MarkStack(MarkStackThreadSharedData& shared, unsigned markerIndex)
+        : m_jsArrayVPtr(shared.m_jsArrayVPtr)
+        , m_jsFinalObjectVPtr(shared.m_jsFinalObjectVPtr)
+        , m_jsStringVPtr(shared.m_jsStringVPtr)
+        , m_shared(shared)
+        , m_markerIndex(markerIndex)
 #if !ASSERT_DISABLED
         , m_isCheckingForDefaultMarkViolation(false)
         , m_isDraining(false)
@@ -152,19 +216,29 @@ namespace JSC {
         ASSERT(m_stack.isEmpty());
     }
 
-    inline bool MarkStack::addOpaqueRoot(void* root)
+    inline void MarkStack::addOpaqueRoot(void* root)
     {
-        return m_opaqueRoots.add(root).second;
+#if ENABLE(PARALLEL_GC)
+        // Other markers may be adding too; keep a private set and merge it when draining ends.
+        if (m_shared.m_numberOfMarkers > 1) {
+            m_opaqueRoots.add(root);
+            return;
+        }
+#endif
+        m_shared.m_opaqueRoots.add(root);
     }
 
+    // Only valid while no marker is draining, so that every private set has been merged.
     inline bool MarkStack::containsOpaqueRoot(void* root)
     {
-        return m_opaqueRoots.contains(root);
+        ASSERT(m_opaqueRoots.isEmpty());
+        return m_shared.m_opaqueRoots.contains(root);
     }
 
     inline int MarkStack::opaqueRootCount()
     {
-        return m_opaqueRoots.size();
+        ASSERT(m_opaqueRoots.isEmpty());
+        return m_shared.m_opaqueRoots.size();
     }
 
     inline void* MarkStack::allocateStack(size_t size)
@@ -234,8 +308,6 @@ namespace JSC {
         internalAppend(value.asCell());
     }
 
-    class SlotVisitor;
-
 } // namespace JSC
 
 #endif
@@ -113,6 +113,8 @@ namespace JSC {
         void clearMarks();
         size_t markCount();
         bool markCountIsZero(); // Faster than markCount().
+        bool isFull(); // True if every cell survived the last collection.
+        bool needsSweeping(); // True if dead cells still await their destructors.
 
         size_t cellSize();
 
@@ -237,6 +239,19 @@ namespace JSC {
         return m_marks.isEmpty();
     }
 
+    inline bool MarkedBlock::needsSweeping()
+    {
+        return m_state == Marked && !isFull();
+    }
+
+    inline bool MarkedBlock::isFull()
+    {
+        if (m_state != Marked)
+            return false;
+        size_t cellCount = (m_endAtom - firstAtom() + m_atomsPerCell - 1) / m_atomsPerCell;
+        return markCount() == cellCount;
+    }
+
     inline size_t MarkedBlock::cellSize()
     {
         return m_atomsPerCell * atomSize;
@@ -264,7 +279,11 @@ namespace JSC {
 
     inline bool MarkedBlock::testAndSetMarked(const void* p)
     {
+#if ENABLE(PARALLEL_GC)
+        return m_marks.concurrentTestAndSet(atomNumber(p));
+#else
         return m_marks.testAndSet(atomNumber(p));
+#endif
     }
 
     inline void MarkedBlock::setMarked(const void* p)
@@ -33,15 +33,42 @@ namespace JSC {
 class SlotVisitor : public MarkStack {
     friend class HeapRootVisitor;
 public:
-    SlotVisitor(void* jsArrayVPtr, void* jsFinalObjectVPtr, void* jsStringVPtr);
+    SlotVisitor(MarkStackThreadSharedData&, unsigned markerIndex = 0);
 
+    void donate();
     void drain();
+    void donateAndDrain();
+
+    enum SharedDrainMode { SlaveDrain, MasterDrain };
+    // Steals work from the shared stack until every marker runs dry. The
+    // collecting thread uses MasterDrain and returns at termination; helper
+    // threads use SlaveDrain and only return when the heap goes away.
+    void drainFromShared(SharedDrainMode);
+
     void harvestWeakReferences();
+
+private:
+    void donateKnownParallel();
+    void publishVisitCountWhileHoldingLock();
 };
 
-inline SlotVisitor::SlotVisitor(void* jsArrayVPtr, void* jsFinalObjectVPtr, void* jsStringVPtr)
-    : MarkStack(jsArrayVPtr, jsFinalObjectVPtr, jsStringVPtr)
+inline SlotVisitor::SlotVisitor(MarkStackThreadSharedData& shared, unsigned markerIndex)
+    : MarkStack(shared, markerIndex)
+{
+}
+
+inline void SlotVisitor::donate()
+{
+#if ENABLE(PARALLEL_GC)
+    if (m_shared.numberOfMarkers() > 1)
+        donateKnownParallel();
+#endif
+}
+
+inline void SlotVisitor::donateAndDrain()
 {
+    donate();
+    drain();
 }
 
 } // namespace JSC
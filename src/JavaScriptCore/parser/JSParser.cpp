@@ -62,7 +62,7 @@ namespace JSC {
 #define consumeOrFail(tokenType) do { if (!consume(tokenType)) failWithToken(tokenType); } while (0)
 #define consumeOrFailWithFlags(tokenType, flags) do { if (!consume(tokenType, flags)) failWithToken(tokenType); } while (0)
 #define matchOrFail(tokenType) do { if (!match(tokenType)) failWithToken(tokenType); } while (0)
-#define failIfStackOverflow() do { failIfFalseWithMessage(canRecurse(), "Code nested too deeply."); } while (0)
+#define failIfStackOverflow() do { failIfFalseWithMessage(canRecurse(), jsParseStackOverflowMessage); } while (0)
 
 // Macros to make the more common TreeBuilder types a little less verbose
 #define TreeStatement typename TreeBuilder::Statement
@@ -82,7 +82,7 @@ COMPILE_ASSERT(LastUntaggedToken < 64, LessThan64UntaggedTokens);
 
 class JSParser {
 public:
-    JSParser(Lexer*, JSGlobalData*, FunctionParameters*, bool isStrictContext, bool isFunction, const SourceCode*);
+    JSParser(Lexer*, JSGlobalData*, FunctionParameters*, bool isStrictContext, bool isFunction, bool parsesLazily, const SourceCode*);
     UString parseProgram();
 private:
     struct AllowInOverride {
@@ -516,6 +516,7 @@ private:
     template <class TreeBuilder> ALWAYS_INLINE TreeConstDeclList parseConstDeclarationList(TreeBuilder& context);
     enum FunctionRequirements { FunctionNoRequirements, FunctionNeedsName };
     template <FunctionRequirements, bool nameIsInContainingScope, class TreeBuilder> bool parseFunctionInfo(TreeBuilder&, const Identifier*&, TreeFormalParameterList&, TreeFunctionBody&, int& openBrace, int& closeBrace, int& bodyStartLine);
+    bool skipFunctionBody();
     ALWAYS_INLINE int isBinaryOperator(JSTokenType token);
     bool allowAutomaticSemicolon();
 
@@ -554,6 +555,8 @@ private:
     int m_statementDepth;
     int m_nonTrivialExpressionCount;
     const Identifier* m_lastIdentifier;
+    bool m_parsesLazily;
+    bool m_functionIsParenthesized;
 
     struct DepthManager {
         DepthManager(int* depth)
@@ -900,20 +903,24 @@ private:
 
     const SourceProviderCacheItem* findCachedFunctionInfo(int openBracePos) 
     {
-        return m_functionCache ? m_functionCache->get(openBracePos) : 0;
+        return m_functionCache ? m_functionCache->get(openBracePos, m_lexer->sourceProvider()->length(), m_globalData) : 0;
     }
 
     SourceProviderCache* m_functionCache;
+    Vector<int> m_addedFunctionCacheItems;
     const SourceCode* m_source;
 };
 
-UString jsParse(JSGlobalData* globalData, FunctionParameters* parameters, JSParserStrictness strictness, JSParserMode parserMode, const SourceCode* source)
+const char* const jsParseStackOverflowMessage = "Code nested too deeply.";
+
+UString jsParse(JSGlobalData* globalData, FunctionParameters* parameters, JSParserStrictness strictness, JSParserMode parserMode, JSParserLaziness laziness, const SourceCode* source)
 {
-    JSParser parser(globalData->lexer, globalData, parameters, strictness == JSParseStrict, parserMode == JSParseFunctionCode, source);
+    bool parsesLazily = laziness == JSParseLazily && parserMode == JSParseProgramCode;
+    JSParser parser(globalData->lexer, globalData, parameters, strictness == JSParseStrict, parserMode == JSParseFunctionCode, parsesLazily, source);
     return parser.parseProgram();
 }
 
-JSParser::JSParser(Lexer* lexer, JSGlobalData* globalData, FunctionParameters* parameters, bool inStrictContext, bool isFunction, const SourceCode* source)
+JSParser::JSParser(Lexer* lexer, JSGlobalData* globalData, FunctionParameters* parameters, bool inStrictContext, bool isFunction, bool parsesLazily, const SourceCode* source)
     : m_lexer(lexer)
     , m_stack(globalData->stack())
     , m_error(false)
@@ -928,6 +935,8 @@ JSParser::JSParser(Lexer* lexer, JSGlobalData* globalData, FunctionParameters* p
     , m_statementDepth(0)
     , m_nonTrivialExpressionCount(0)
     , m_lastIdentifier(0)
+    , m_parsesLazily(parsesLazily)
+    , m_functionIsParenthesized(false)
     , m_functionCache(m_lexer->sourceProvider()->cache())
     , m_source(source)
 {
@@ -952,8 +961,16 @@ UString JSParser::parseProgram()
         m_statementDepth--;
     ScopeRef scope = currentScope();
     SourceElements* sourceElements = parseSourceElements<CheckForStrictMode>(context);
-    if (!sourceElements || !consume(EOFTOK))
+    if (!sourceElements || !consume(EOFTOK)) {
+        // A failed lazy parse is retried eagerly, which must not trust what this one cached.
+        for (size_t i = 0; i < m_addedFunctionCacheItems.size(); ++i)
+            m_functionCache->remove(m_addedFunctionCacheItems[i]);
+        // Items decoded from disk along the way stay, so their size still has to be reported.
+        unsigned functionCacheSize = m_functionCache ? m_functionCache->byteSize() : 0;
+        if (functionCacheSize != oldFunctionCacheSize)
+            m_lexer->sourceProvider()->notifyCacheSizeChanged(functionCacheSize - oldFunctionCacheSize);
         return m_errorMessage;
+    }
     IdentifierSet capturedVariables;
     scope->getCapturedVariables(capturedVariables);
     CodeFeatures features = context.features();
@@ -1591,6 +1608,8 @@ template <class TreeBuilder> TreeFunctionBody JSParser::parseFunctionBody(TreeBu
 
 template <JSParser::FunctionRequirements requirements, bool nameIsInContainingScope, class TreeBuilder> bool JSParser::parseFunctionInfo(TreeBuilder& context, const Identifier*& name, TreeFormalParameterList& parameters, TreeFunctionBody& body, int& openBracePos, int& closeBracePos, int& bodyStartLine)
 {
+    bool isParenthesized = m_functionIsParenthesized;
+    m_functionIsParenthesized = false;
     AutoPopScopeRef functionScope(this, pushScope());
     functionScope->setIsFunction();
     if (match(IDENT)) {
@@ -1622,6 +1641,8 @@ template <JSParser::FunctionRequirements requirements, bool nameIsInContainingSc
         failIfFalse(popScope(functionScope, TreeBuilder::NeedsFreeVariableInfo));
 
         closeBracePos = cachedInfo->closeBracePos;
+        m_globalData->parser->statistics().functionBodiesFromCache++;
+        m_globalData->parser->statistics().skippedCharacters += closeBracePos - openBracePos;
         m_token = cachedInfo->closeBraceToken();
         m_lexer->setOffset(m_token.m_info.endOffset);
         m_lexer->setLineNumber(m_token.m_info.line);
@@ -1630,10 +1651,19 @@ template <JSParser::FunctionRequirements requirements, bool nameIsInContainingSc
         return true;
     }
 
-    next();
-
-    body = parseFunctionBody(context);
-    failIfFalse(body);
+    // A lazy parse leaves the bodies of functions declared in program code for
+    // their first call. Their free variables would only matter to an enclosing
+    // function, and a parenthesized function is most likely called right away.
+    if (TreeBuilder::CanUseFunctionCache && m_parsesLazily && !isParenthesized && m_scopeStack.size() == 2) {
+        failIfFalse(skipFunctionBody());
+        body = context.createFunctionBody(strictMode());
+        m_globalData->parser->statistics().functionBodiesSkipped++;
+        m_globalData->parser->statistics().skippedCharacters += m_token.m_data.intValue - openBracePos;
+    } else {
+        next();
+        body = parseFunctionBody(context);
+        failIfFalse(body);
+    }
     if (functionScope->strictMode() && name) {
         failIfTrueWithNameAndMessage(m_globalData->propertyNames->arguments == *name, "Function name", name->impl(), "is not valid in strict mode");
         failIfTrueWithNameAndMessage(m_globalData->propertyNames->eval == *name, "Function name", name->impl(), "is not valid in strict mode");
@@ -1656,12 +1686,93 @@ template <JSParser::FunctionRequirements requirements, bool nameIsInContainingSc
     if (newInfo) {
         unsigned approximateByteSize = newInfo->approximateByteSize();
         m_functionCache->add(openBracePos, newInfo.release(), approximateByteSize);
+        if (m_parsesLazily)
+            m_addedFunctionCacheItems.append(openBracePos);
     }
 
     next();
     return true;
 }
 
+static inline bool tokenCanEndOperand(JSTokenType type)
+{
+    switch (type) {
+    case IDENT:
+    case NUMBER:
+    case STRING:
+    case CLOSEPAREN:
+    case CLOSEBRACKET:
+    case CLOSEBRACE:
+    case THISTOKEN:
+    case NULLTOKEN:
+    case TRUETOKEN:
+    case FALSETOKEN:
+    case PLUSPLUS:
+    case MINUSMINUS:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Moves from the open brace of a function body to its close brace looking only
+// at tokens, apart from the directive prologue that can make the body strict.
+// A slash after a token that can end an operand is taken for a division, so
+// "if (x) /re/" can throw the count off; parseProgram() then fails and the
+// Parser retries eagerly.
+bool JSParser::skipFunctionBody()
+{
+    ASSERT(match(OPENBRACE));
+    next();
+    bool slashIsDivision = false;
+    while (match(STRING)) {
+        const Identifier* directive = m_token.m_data.ident;
+        next();
+        slashIsDivision = true;
+        if (!match(SEMICOLON) && !match(CLOSEBRACE) && !m_lexer->prevTerminator())
+            break;
+        if (m_globalData->propertyNames->useStrictIdentifier == *directive) {
+            setStrictMode();
+            failIfFalse(isValidStrictMode());
+        }
+        if (match(SEMICOLON)) {
+            next();
+            slashIsDivision = false;
+        }
+    }
+
+    unsigned depth = 1;
+    while (true) {
+        switch (m_token.m_type) {
+        case OPENBRACE:
+            depth++;
+            break;
+        case CLOSEBRACE:
+            if (!--depth)
+                return true;
+            break;
+        case DIVIDE:
+        case DIVEQUAL:
+            if (!slashIsDivision) {
+                const Identifier* pattern;
+                const Identifier* flags;
+                failIfFalse(m_lexer->scanRegExp(pattern, flags, match(DIVEQUAL) ? '=' : 0));
+                next();
+                slashIsDivision = true;
+                continue;
+            }
+            break;
+        case EOFTOK:
+        case ERRORTOK:
+            return false;
+        default:
+            break;
+        }
+        slashIsDivision = tokenCanEndOperand(m_token.m_type);
+        next();
+    }
+}
+
 template <class TreeBuilder> TreeStatement JSParser::parseFunctionDeclaration(TreeBuilder& context)
 {
     ASSERT(match(FUNCTION));
@@ -2291,6 +2402,10 @@ template <class TreeBuilder> TreeExpression JSParser::parseMemberExpression(Tree
         int openBracePos = 0;
         int closeBracePos = 0;
         int bodyStartLine = 0;
+        if (m_parsesLazily && m_lastTokenEnd > m_source->startOffset()) {
+            UChar previous = m_source->provider()->data()[m_lastTokenEnd - 1];
+            m_functionIsParenthesized = previous == '(' || previous == '!';
+        }
         next();
         failIfFalse((parseFunctionInfo<FunctionNoRequirements, false>(context, name, parameters, body, openBracePos, closeBracePos, bodyStartLine)));
         base = context.createFunctionExpr(name, body, parameters, openBracePos, closeBracePos, bodyStartLine, m_lastLine);
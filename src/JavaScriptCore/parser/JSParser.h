@@ -161,7 +161,13 @@ struct JSToken {
 
 enum JSParserStrictness { JSParseNormal, JSParseStrict };
 enum JSParserMode { JSParseProgramCode, JSParseFunctionCode };
+// A lazy parse only brace-matches the bodies of functions declared directly in
+// program code; they are checked when first compiled.
+enum JSParserLaziness { JSParseEagerly, JSParseLazily };
 
-UString jsParse(JSGlobalData*, FunctionParameters*, JSParserStrictness, JSParserMode, const SourceCode*);
+UString jsParse(JSGlobalData*, FunctionParameters*, JSParserStrictness, JSParserMode, JSParserLaziness, const SourceCode*);
+
+// The error jsParse() reports when code is nested too deeply to parse.
+extern const char* const jsParseStackOverflowMessage;
 }
 #endif // JSParser_h
@@ -29,7 +29,7 @@
 
 namespace JSC {
 
-void Parser::parse(JSGlobalData* globalData, FunctionParameters* parameters, JSParserStrictness strictness, JSParserMode mode, int* errLine, UString* errMsg)
+void Parser::parse(JSGlobalData* globalData, FunctionParameters* parameters, JSParserStrictness strictness, JSParserMode mode, JSParserLaziness laziness, int* errLine, UString* errMsg)
 {
     ASSERT(globalData);
     m_sourceElements = 0;
@@ -48,7 +48,16 @@ void Parser::parse(JSGlobalData* globalData, FunctionParameters* parameters, JSP
     Lexer& lexer = *globalData->lexer;
     lexer.setCode(*m_source, m_arena);
 
-    UString parseError = jsParse(globalData, parameters, strictness, mode, m_source);
+    UString parseError = jsParse(globalData, parameters, strictness, mode, laziness, m_source);
+    if (!parseError.isNull() && laziness == JSParseLazily) {
+        // The brace matcher may have taken a regular expression for a division and
+        // lost its place. Parse eagerly to either succeed or report the real error.
+        m_statistics.lazyParseRetries++;
+        lexer.clear();
+        m_arena.reset();
+        lexer.setCode(*m_source, m_arena);
+        parseError = jsParse(globalData, parameters, strictness, mode, JSParseEagerly, m_source);
+    }
     int lineNumber = lexer.lineNumber();
     bool lexError = lexer.sawError();
     UString lexErrorMessage = lexError ? lexer.getErrorMessage() : UString();
@@ -31,6 +31,7 @@
 #include "Nodes.h"
 #include "ParserArena.h"
 #include "SourceProvider.h"
+#include <wtf/CurrentTime.h>
 #include <wtf/Forward.h>
 #include <wtf/Noncopyable.h>
 #include <wtf/OwnPtr.h>
@@ -47,12 +48,36 @@ namespace JSC {
     template <> inline bool isEvalNode<EvalNode>() { return true; }
     template <typename T> struct ParserArenaData : ParserArenaDeletable { T data; };
 
+    struct ParserStatistics {
+        ParserStatistics()
+            : programsParsed(0)
+            , functionsParsed(0)
+            , functionBodiesSkipped(0)
+            , functionBodiesFromCache(0)
+            , skippedCharacters(0)
+            , lazyParseRetries(0)
+            , parseTime(0)
+        {
+        }
+
+        unsigned programsParsed; // Program and eval code.
+        unsigned functionsParsed; // Function bodies, parsed again when first compiled.
+        unsigned functionBodiesSkipped; // Brace-matched by a lazy parse.
+        unsigned functionBodiesFromCache; // Skipped thanks to the SourceProviderCache.
+        size_t skippedCharacters; // Source characters in both kinds of skipped bodies.
+        unsigned lazyParseRetries; // Lazy parses that failed and were done again eagerly.
+        double parseTime; // Seconds.
+    };
+
     class Parser {
         WTF_MAKE_NONCOPYABLE(Parser); WTF_MAKE_FAST_ALLOCATED;
     public:
+        // Program code at least this long is parsed lazily when possible.
+        static const int minimumSourceLengthToParseLazily = 32 * 1024;
+
         Parser() { }
         template <class ParsedNode>
-        PassRefPtr<ParsedNode> parse(JSGlobalObject* lexicalGlobalObject, Debugger*, ExecState*, const SourceCode& source, FunctionParameters*, JSParserStrictness strictness, JSObject** exception);
+        PassRefPtr<ParsedNode> parse(JSGlobalObject* lexicalGlobalObject, Debugger*, ExecState*, const SourceCode& source, FunctionParameters*, JSParserStrictness strictness, JSObject** exception, JSParserLaziness = JSParseEagerly);
 
         void didFinishParsing(SourceElements*, ParserArenaData<DeclarationStacks::VarStack>*, 
                               ParserArenaData<DeclarationStacks::FunctionStack>*, CodeFeatures features,
@@ -60,8 +85,10 @@ namespace JSC {
 
         ParserArena& arena() { return m_arena; }
 
+        ParserStatistics& statistics() { return m_statistics; }
+
     private:
-        void parse(JSGlobalData*, FunctionParameters*, JSParserStrictness strictness, JSParserMode mode, int* errLine, UString* errMsg);
+        void parse(JSGlobalData*, FunctionParameters*, JSParserStrictness strictness, JSParserMode mode, JSParserLaziness, int* errLine, UString* errMsg);
 
         // Used to determine type of error to report.
         bool isFunctionBodyNode(ScopeNode*) { return false; }
@@ -76,20 +103,28 @@ namespace JSC {
         CodeFeatures m_features;
         int m_lastLine;
         int m_numConstants;
+        ParserStatistics m_statistics;
     };
 
     template <class ParsedNode>
-    PassRefPtr<ParsedNode> Parser::parse(JSGlobalObject* lexicalGlobalObject, Debugger* debugger, ExecState* debuggerExecState, const SourceCode& source, FunctionParameters* parameters, JSParserStrictness strictness, JSObject** exception)
+    PassRefPtr<ParsedNode> Parser::parse(JSGlobalObject* lexicalGlobalObject, Debugger* debugger, ExecState* debuggerExecState, const SourceCode& source, FunctionParameters* parameters, JSParserStrictness strictness, JSObject** exception, JSParserLaziness laziness)
     {
         ASSERT(lexicalGlobalObject);
         ASSERT(exception && !*exception);
+        ASSERT(laziness == JSParseEagerly || !ParsedNode::scopeIsFunction);
         int errLine;
         UString errMsg;
 
+        double startTime = monotonicallyIncreasingTime();
         m_source = &source;
         if (ParsedNode::scopeIsFunction)
             lexicalGlobalObject->globalData().lexer->setIsReparsing();
-        parse(&lexicalGlobalObject->globalData(), parameters, strictness, ParsedNode::isFunctionNode ? JSParseFunctionCode : JSParseProgramCode, &errLine, &errMsg);
+        parse(&lexicalGlobalObject->globalData(), parameters, strictness, ParsedNode::isFunctionNode ? JSParseFunctionCode : JSParseProgramCode, laziness, &errLine, &errMsg);
+        m_statistics.parseTime += monotonicallyIncreasingTime() - startTime;
+        if (ParsedNode::isFunctionNode)
+            m_statistics.functionsParsed++;
+        else
+            m_statistics.programsParsed++;
 
         RefPtr<ParsedNode> result;
         if (m_sourceElements) {
@@ -103,13 +138,11 @@ namespace JSC {
                 m_numConstants);
             result->setLoc(m_source->firstLine(), m_lastLine);
         } else if (lexicalGlobalObject) {
-            // We can never see a syntax error when reparsing a function, since we should have
-            // reported the error when parsing the containing program or eval code. So if we're
-            // parsing a function body node, we assume that what actually happened here is that
-            // we ran out of stack while parsing. If we see an error while parsing eval or program
-            // code we assume that it was a syntax error since running out of stack is much less
-            // likely, and we are currently unable to distinguish between the two cases.
-            if (isFunctionBodyNode(static_cast<ParsedNode*>(0)))
+            // A function body is reparsed without a syntax error unless a lazy parse of the
+            // containing program skipped it, so running out of stack is the usual failure.
+            // If we see an error while parsing eval or program code we assume that it was a
+            // syntax error since running out of stack is much less likely there.
+            if (isFunctionBodyNode(static_cast<ParsedNode*>(0)) && errMsg == jsParseStackOverflowMessage)
                 *exception = createStackOverflowError(lexicalGlobalObject);
             else if (isEvalNode<ParsedNode>())
                 *exception = createSyntaxError(lexicalGlobalObject, errMsg);
@@ -26,10 +26,116 @@
 #include "config.h"
 #include "SourceProviderCache.h"
 
+#include "Identifier.h"
 #include "SourceProviderCacheItem.h"
+#include <limits>
 
 namespace JSC {
 
+// Encoded layout, in host byte order:
+//   header: magic, encodedFormatVersion, item count
+//   item:   open brace position, close brace line, close brace position,
+//           flags, used variable count, written variable count, then each
+//           variable as a length followed by its UTF-16 characters.
+static const uint32_t encodedMagic = 0x4350534a; // "JSPC"
+
+enum EncodedItemFlag {
+    UsesEvalFlag = 1 << 0,
+    StrictModeFlag = 1 << 1,
+    NeedsFullActivationFlag = 1 << 2
+};
+
+class EncodedReader {
+public:
+    EncodedReader(const char* data, size_t length)
+        : m_data(data)
+        , m_length(length)
+        , m_offset(0)
+    {
+    }
+
+    size_t offset() const { return m_offset; }
+    bool atEnd() const { return m_offset == m_length; }
+
+    bool readUInt32(uint32_t& value)
+    {
+        if (m_length - m_offset < sizeof(value))
+            return false;
+        memcpy(&value, m_data + m_offset, sizeof(value));
+        m_offset += sizeof(value);
+        return true;
+    }
+
+    bool readCharacters(uint32_t length, Vector<UChar, 64>& characters)
+    {
+        if (length > (m_length - m_offset) / sizeof(UChar))
+            return false;
+        characters.resize(length);
+        memcpy(characters.data(), m_data + m_offset, length * sizeof(UChar));
+        m_offset += length * sizeof(UChar);
+        return true;
+    }
+
+    bool skipCharacters(uint32_t length)
+    {
+        if (length > (m_length - m_offset) / sizeof(UChar))
+            return false;
+        m_offset += length * sizeof(UChar);
+        return true;
+    }
+
+private:
+    const char* m_data;
+    size_t m_length;
+    size_t m_offset;
+};
+
+static void appendUInt32(Vector<char>& buffer, uint32_t value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void encodeVariables(Vector<char>& buffer, const Vector<RefPtr<StringImpl> >& variables)
+{
+    for (size_t i = 0; i < variables.size(); ++i) {
+        StringImpl* variable = variables[i].get();
+        appendUInt32(buffer, variable->length());
+        buffer.append(reinterpret_cast<const char*>(variable->characters()), variable->length() * sizeof(UChar));
+    }
+}
+
+static void encodeItem(Vector<char>& buffer, int sourcePosition, const SourceProviderCacheItem& item)
+{
+    uint32_t flags = 0;
+    if (item.usesEval)
+        flags |= UsesEvalFlag;
+    if (item.strictMode)
+        flags |= StrictModeFlag;
+    if (item.needsFullActivation)
+        flags |= NeedsFullActivationFlag;
+
+    appendUInt32(buffer, sourcePosition);
+    appendUInt32(buffer, item.closeBraceLine);
+    appendUInt32(buffer, item.closeBracePos);
+    appendUInt32(buffer, flags);
+    appendUInt32(buffer, item.usedVariables.size());
+    appendUInt32(buffer, item.writtenVariables.size());
+    encodeVariables(buffer, item.usedVariables);
+    encodeVariables(buffer, item.writtenVariables);
+}
+
+static void decodeVariables(EncodedReader& reader, uint32_t count, Vector<RefPtr<StringImpl> >& variables, JSGlobalData* globalData)
+{
+    Vector<UChar, 64> characters;
+    variables.reserveInitialCapacity(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t length = 0;
+        reader.readUInt32(length);
+        reader.readCharacters(length, characters);
+        variables.append(Identifier(globalData, characters.data(), length).impl());
+    }
+}
+
 SourceProviderCache::~SourceProviderCache()
 {
     clear();
@@ -40,17 +146,150 @@ void SourceProviderCache::clear()
     deleteAllValues(m_map);
     m_map.clear();
     m_contentByteSize = 0;
+    m_hasUnsavedItems = false;
+    m_encodedData.clear();
+    m_encodedItems.clear();
 }
 
 unsigned SourceProviderCache::byteSize() const
 { 
-    return m_contentByteSize + sizeof(*this) + m_map.capacity() * sizeof(SourceProviderCacheItem*);
+    return m_contentByteSize + sizeof(*this) + m_map.capacity() * sizeof(SourceProviderCacheItem*) + m_encodedData.size();
 }
 
 void SourceProviderCache::add(int sourcePosition, PassOwnPtr<SourceProviderCacheItem> item, unsigned size)
 {
     m_map.add(sourcePosition, item.leakPtr());
     m_contentByteSize += size;
+    m_hasUnsavedItems = true;
+}
+
+void SourceProviderCache::remove(int sourcePosition)
+{
+    SourceProviderCacheItem* item = m_map.take(sourcePosition);
+    if (!item)
+        return;
+    m_contentByteSize -= item->approximateByteSize();
+    delete item;
+}
+
+bool SourceProviderCache::decode(const char* data, size_t length)
+{
+    EncodedReader reader(data, length);
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t count = 0;
+    if (!reader.readUInt32(magic) || magic != encodedMagic)
+        return false;
+    if (!reader.readUInt32(version) || version != encodedFormatVersion)
+        return false;
+    if (!reader.readUInt32(count))
+        return false;
+
+    // Walk every item up front so that a truncated or corrupt buffer is
+    // rejected as a whole, and remember where each one starts.
+    HashMap<int, EncodedItem> items;
+    for (uint32_t i = 0; i < count; ++i) {
+        size_t itemOffset = reader.offset();
+        uint32_t sourcePosition = 0;
+        uint32_t closeBraceLine = 0;
+        uint32_t closeBracePos = 0;
+        uint32_t unused = 0;
+        uint32_t usedCount = 0;
+        uint32_t writtenCount = 0;
+        if (!reader.readUInt32(sourcePosition) || !sourcePosition || sourcePosition > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+            return false;
+        if (!reader.readUInt32(closeBraceLine) || !closeBraceLine || closeBraceLine > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+            return false;
+        if (!reader.readUInt32(closeBracePos) || closeBracePos <= sourcePosition || closeBracePos > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+            return false;
+        if (!reader.readUInt32(unused))
+            return false;
+        if (!reader.readUInt32(usedCount) || !reader.readUInt32(writtenCount))
+            return false;
+        for (uint64_t j = 0; j < static_cast<uint64_t>(usedCount) + writtenCount; ++j) {
+            uint32_t variableLength = 0;
+            if (!reader.readUInt32(variableLength) || !reader.skipCharacters(variableLength))
+                return false;
+        }
+
+        if (m_map.contains(sourcePosition))
+            continue;
+        EncodedItem item = { static_cast<unsigned>(itemOffset), static_cast<unsigned>(reader.offset() - itemOffset) };
+        items.set(sourcePosition, item);
+    }
+    if (!reader.atEnd())
+        return false;
+
+    m_encodedData.clear();
+    m_encodedData.append(data, length);
+    m_encodedItems.swap(items);
+    return true;
+}
+
+const SourceProviderCacheItem* SourceProviderCache::decodeItem(int sourcePosition, int sourceLength, JSGlobalData* globalData)
+{
+    HashMap<int, EncodedItem>::iterator it = m_encodedItems.find(sourcePosition);
+    if (it == m_encodedItems.end())
+        return 0;
+
+    // decode() has already checked the bounds of every field, but only the
+    // parser knows how long the source is.
+    EncodedReader reader(m_encodedData.data() + it->second.offset, it->second.length);
+    m_encodedItems.remove(it);
+
+    uint32_t encodedPosition = 0;
+    uint32_t closeBraceLine = 0;
+    uint32_t closeBracePos = 0;
+    uint32_t flags = 0;
+    uint32_t usedCount = 0;
+    uint32_t writtenCount = 0;
+    reader.readUInt32(encodedPosition);
+    reader.readUInt32(closeBraceLine);
+    reader.readUInt32(closeBracePos);
+    reader.readUInt32(flags);
+    reader.readUInt32(usedCount);
+    reader.readUInt32(writtenCount);
+    ASSERT(static_cast<int>(encodedPosition) == sourcePosition);
+
+    // The lexer resumes right after the close brace, so it must lie inside the source.
+    if (static_cast<int>(closeBracePos) >= sourceLength) {
+        m_hasUnsavedItems = true;
+        if (m_encodedItems.isEmpty())
+            m_encodedData.clear();
+        return 0;
+    }
+
+    OwnPtr<SourceProviderCacheItem> item = adoptPtr(new SourceProviderCacheItem(closeBraceLine, closeBracePos));
+    item->usesEval = flags & UsesEvalFlag;
+    item->strictMode = flags & StrictModeFlag;
+    item->needsFullActivation = flags & NeedsFullActivationFlag;
+    decodeVariables(reader, usedCount, item->usedVariables, globalData);
+    decodeVariables(reader, writtenCount, item->writtenVariables, globalData);
+    ASSERT(reader.atEnd());
+
+    if (m_encodedItems.isEmpty())
+        m_encodedData.clear();
+
+    SourceProviderCacheItem* result = item.get();
+    m_contentByteSize += result->approximateByteSize();
+    m_map.add(sourcePosition, item.leakPtr());
+    return result;
+}
+
+void SourceProviderCache::encode(Vector<char>& buffer) const
+{
+    buffer.clear();
+    appendUInt32(buffer, encodedMagic);
+    appendUInt32(buffer, encodedFormatVersion);
+    appendUInt32(buffer, m_map.size() + m_encodedItems.size());
+
+    HashMap<int, SourceProviderCacheItem*>::const_iterator end = m_map.end();
+    for (HashMap<int, SourceProviderCacheItem*>::const_iterator it = m_map.begin(); it != end; ++it)
+        encodeItem(buffer, it->first, *it->second);
+
+    HashMap<int, EncodedItem>::const_iterator encodedEnd = m_encodedItems.end();
+    for (HashMap<int, EncodedItem>::const_iterator it = m_encodedItems.begin(); it != encodedEnd; ++it)
+        buffer.append(m_encodedData.data() + it->second.offset, it->second.length);
 }
 
 }
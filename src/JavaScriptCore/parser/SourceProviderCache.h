@@ -25,24 +25,59 @@
 
 #include <wtf/HashMap.h>
 #include <wtf/PassOwnPtr.h>
+#include <wtf/Vector.h>
 
 namespace JSC {
 
+class JSGlobalData;
 class SourceProviderCacheItem;
 
 class SourceProviderCache {
 public:
-    SourceProviderCache() : m_contentByteSize(0) {}
+    // Bump whenever the parser changes what it records about a function, so
+    // that caches written by an older engine are ignored.
+    static const unsigned encodedFormatVersion = 1;
+
+    SourceProviderCache() : m_contentByteSize(0), m_hasUnsavedItems(false) {}
     JS_EXPORT_PRIVATE ~SourceProviderCache();
 
     JS_EXPORT_PRIVATE void clear();
     JS_EXPORT_PRIVATE unsigned byteSize() const;
     void add(int sourcePosition, PassOwnPtr<SourceProviderCacheItem>, unsigned size);
-    const SourceProviderCacheItem* get(int sourcePosition) const { return m_map.get(sourcePosition); }
+    void remove(int sourcePosition);
+    const SourceProviderCacheItem* get(int sourcePosition, int sourceLength, JSGlobalData*);
+
+    // Persistence. decode() keeps the buffer and only turns an item back into
+    // a SourceProviderCacheItem when the parser first asks for it. encode()
+    // writes out every item, decoded or not.
+    JS_EXPORT_PRIVATE bool decode(const char* data, size_t length);
+    JS_EXPORT_PRIVATE void encode(Vector<char>&) const;
+    bool hasUnsavedItems() const { return m_hasUnsavedItems; }
+    void didSave() { m_hasUnsavedItems = false; }
 
 private:
+    struct EncodedItem {
+        unsigned offset;
+        unsigned length;
+    };
+
+    const SourceProviderCacheItem* decodeItem(int sourcePosition, int sourceLength, JSGlobalData*);
+
     HashMap<int, SourceProviderCacheItem*> m_map;
     unsigned m_contentByteSize;
+    bool m_hasUnsavedItems;
+
+    Vector<char> m_encodedData;
+    HashMap<int, EncodedItem> m_encodedItems;
 };
 
+inline const SourceProviderCacheItem* SourceProviderCache::get(int sourcePosition, int sourceLength, JSGlobalData* globalData)
+{
+    if (const SourceProviderCacheItem* item = m_map.get(sourcePosition))
+        return item;
+    if (m_encodedItems.isEmpty())
+        return 0;
+    return decodeItem(sourcePosition, sourceLength, globalData);
+}
+
 }
@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "SamplingProfiler.h"
+
+#if ENABLE(SAMPLING_PROFILER)
+
+#include "CodeBlock.h"
+#include "Executable.h"
+#include "Interpreter.h"
+#include "JSGlobalData.h"
+#include <windows.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/text/StringBuilder.h>
+
+namespace JSC {
+
+static String frameName(CodeBlock* codeBlock)
+{
+    ScriptExecutable* executable = codeBlock->ownerExecutable();
+
+    StringBuilder builder;
+    switch (codeBlock->codeType()) {
+    case FunctionCode: {
+        const UString& name = static_cast<FunctionExecutable*>(executable)->name().ustring();
+        if (name.isEmpty())
+            builder.append("(anonymous function)");
+        else
+            builder.append(String(name.impl()));
+        break;
+    }
+    case EvalCode:
+        builder.append("(eval)");
+        break;
+    case GlobalCode:
+        builder.append("(program)");
+        break;
+    }
+    builder.append(" (");
+    builder.append(String(executable->sourceURL().impl()));
+    builder.append(':');
+    builder.append(String::number(executable->lineNo()));
+    builder.append(')');
+
+    // ';' separates the frames of a collapsed stack.
+    return builder.toString().replace(';', ',');
+}
+
+SamplingProfiler::SamplingProfiler(JSGlobalData& globalData)
+    : m_globalData(globalData)
+    , m_samplerThread(0)
+    , m_targetThread(0)
+    , m_interval(defaultIntervalInMilliseconds)
+    , m_shouldStop(false)
+{
+    m_frameNames.append("(unknown)");
+    m_frameNames.append("(native)");
+}
+
+SamplingProfiler::~SamplingProfiler()
+{
+    stop();
+}
+
+void SamplingProfiler::didCreateCodeBlock(CodeBlock* codeBlock)
+{
+    ASSERT(isRunning());
+    MutexLocker locker(m_lock);
+    addCodeBlock(codeBlock);
+}
+
+void SamplingProfiler::willDestroyCodeBlock(CodeBlock* codeBlock)
+{
+    ASSERT(isRunning());
+    MutexLocker locker(m_lock);
+    m_codeBlocks.remove(codeBlock);
+}
+
+void SamplingProfiler::addCodeBlock(CodeBlock* codeBlock)
+{
+    // An optimized CodeBlock keeps the baseline one it replaced.
+    for (; codeBlock; codeBlock = codeBlock->alternative())
+        m_codeBlocks.add(codeBlock, frameIndex(codeBlock));
+}
+
+// Every CodeBlock belongs to a live executable, so the heap knows about all
+// of them when the profiler starts.
+struct SamplingProfiler::CodeBlockRegistrar : public MarkedBlock::VoidFunctor {
+    CodeBlockRegistrar(SamplingProfiler& profiler)
+        : profiler(profiler)
+    {
+    }
+
+    void operator()(JSCell* cell)
+    {
+        if (cell->inherits(&FunctionExecutable::s_info)) {
+            FunctionExecutable* executable = static_cast<FunctionExecutable*>(cell);
+            if (executable->isGeneratedForCall())
+                profiler.addCodeBlock(&executable->generatedBytecodeForCall());
+            if (executable->isGeneratedForConstruct())
+                profiler.addCodeBlock(&executable->generatedBytecodeForConstruct());
+        } else if (cell->inherits(&ProgramExecutable::s_info)) {
+            ProgramExecutable* executable = static_cast<ProgramExecutable*>(cell);
+            if (executable->isGenerated())
+                profiler.addCodeBlock(&executable->generatedBytecode());
+        } else if (cell->inherits(&EvalExecutable::s_info)) {
+            EvalExecutable* executable = static_cast<EvalExecutable*>(cell);
+            if (executable->isGenerated())
+                profiler.addCodeBlock(&executable->generatedBytecode());
+        }
+    }
+
+    SamplingProfiler& profiler;
+};
+
+unsigned SamplingProfiler::frameIndex(CodeBlock* codeBlock)
+{
+    String name = frameName(codeBlock);
+    std::pair<HashMap<String, unsigned>::iterator, bool> result = m_frameIndices.add(name, m_frameNames.size());
+    if (result.second)
+        m_frameNames.append(name);
+    return result.first->second;
+}
+
+bool SamplingProfiler::start(unsigned intervalInMilliseconds)
+{
+    if (isRunning())
+        return false;
+
+    HANDLE targetThread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT, FALSE, GetCurrentThreadId());
+    if (!targetThread)
+        return false;
+
+    {
+        MutexLocker locker(m_lock);
+        CodeBlockRegistrar registrar(*this);
+        m_globalData.heap.objectSpace().forEachCell(registrar);
+    }
+
+    m_targetThread = targetThread;
+    m_interval = std::max(intervalInMilliseconds, 1u);
+    m_shouldStop = false;
+    m_samplerThread = createThread(samplerThreadStartFunc, this, "JavaScriptCore::SamplingProfiler");
+    if (!m_samplerThread) {
+        CloseHandle(targetThread);
+        m_targetThread = 0;
+        return false;
+    }
+    return true;
+}
+
+void SamplingProfiler::stop()
+{
+    if (!isRunning())
+        return;
+
+    {
+        MutexLocker locker(m_stopLock);
+        m_shouldStop = true;
+        m_stopCondition.signal();
+    }
+    waitForThreadCompletion(m_samplerThread, 0);
+    m_samplerThread = 0;
+
+    // CodeBlocks are no longer reported, so the table would go stale.
+    {
+        MutexLocker locker(m_lock);
+        m_codeBlocks.clear();
+    }
+
+    CloseHandle(m_targetThread);
+    m_targetThread = 0;
+}
+
+void* SamplingProfiler::samplerThreadStartFunc(void* profiler)
+{
+    static_cast<SamplingProfiler*>(profiler)->samplerThreadMain();
+    return 0;
+}
+
+void SamplingProfiler::samplerThreadMain()
+{
+    MutexLocker locker(m_stopLock);
+    while (!m_shouldStop) {
+        m_stopCondition.timedWait(m_stopLock, currentTime() + m_interval / 1000.0);
+        if (m_shouldStop)
+            break;
+        takeSample();
+    }
+}
+
+void SamplingProfiler::takeSample()
+{
+    unsigned frames[maxStackDepth];
+    size_t depth = 0;
+    bool isTruncated = false;
+
+    MutexLocker locker(m_lock);
+
+    if (SuspendThread(m_targetThread) == static_cast<DWORD>(-1))
+        return;
+    // SuspendThread() only requests the suspension; reading the context
+    // waits until the thread has actually stopped.
+    CONTEXT context;
+    context.ContextFlags = CONTEXT_CONTROL;
+    GetThreadContext(m_targetThread, &context);
+
+    // The interpreter keeps topCallFrame exact. JIT code stores it when it
+    // calls a stub, so time spent in a JIT frame before its first stub call
+    // is charged to the caller. Frame headers may be stale, so only follow
+    // pointers that stay inside the live part of the register file, go down
+    // the stack and name a CodeBlock we know about.
+    RegisterFile& registerFile = m_globalData.interpreter->registerFile();
+    Register* begin = registerFile.begin();
+    Register* end = registerFile.end();
+    CallFrame* callFrame = m_globalData.topCallFrame->removeHostCallFrameFlag();
+    while (callFrame) {
+        if (callFrame->registers() - RegisterFile::CallFrameHeaderSize < begin || callFrame->registers() > end || depth == maxStackDepth) {
+            isTruncated = true;
+            break;
+        }
+
+        unsigned index = NativeFrame;
+        if (CodeBlock* codeBlock = callFrame->codeBlock()) {
+            HashMap<CodeBlock*, unsigned>::iterator it = m_codeBlocks.find(codeBlock);
+            if (it == m_codeBlocks.end()) {
+                isTruncated = true;
+                break;
+            }
+            index = it->second;
+        }
+        frames[depth++] = index;
+
+        CallFrame* callerFrame = callFrame->callerFrame()->removeHostCallFrameFlag();
+        if (callerFrame >= callFrame) {
+            isTruncated = true;
+            break;
+        }
+        callFrame = callerFrame;
+    }
+
+    ResumeThread(m_targetThread);
+
+    ++m_statistics.samples;
+    if (isTruncated)
+        ++m_statistics.truncatedSamples;
+    if (!depth) {
+        if (!isTruncated)
+            ++m_statistics.idleSamples;
+        return;
+    }
+    m_samples.append(depth);
+    m_samples.append(frames, depth);
+}
+
+CString SamplingProfiler::collapsedStacks()
+{
+    MutexLocker locker(m_lock);
+
+    HashMap<String, unsigned> counts;
+    Vector<String> stacks; // In order of first appearance, to keep the output stable.
+    for (size_t i = 0; i < m_samples.size(); ) {
+        size_t depth = m_samples[i++];
+        StringBuilder builder;
+        for (size_t j = depth; j--; ) {
+            builder.append(m_frameNames[m_samples[i + j]]);
+            if (j)
+                builder.append(';');
+        }
+        i += depth;
+
+        std::pair<HashMap<String, unsigned>::iterator, bool> result = counts.add(builder.toString(), 0);
+        if (result.second)
+            stacks.append(result.first->first);
+        ++result.first->second;
+    }
+
+    StringBuilder output;
+    for (size_t i = 0; i < stacks.size(); ++i) {
+        output.append(stacks[i]);
+        output.append(' ');
+        output.append(String::number(counts.get(stacks[i])));
+        output.append('\n');
+    }
+    return output.toString().utf8();
+}
+
+void SamplingProfiler::clearSamples()
+{
+    MutexLocker locker(m_lock);
+    m_samples.clear();
+    m_statistics = SamplingProfilerStatistics();
+}
+
+SamplingProfilerStatistics SamplingProfiler::statistics()
+{
+    MutexLocker locker(m_lock);
+    return m_statistics;
+}
+
+} // namespace JSC
+
+#endif // ENABLE(SAMPLING_PROFILER)
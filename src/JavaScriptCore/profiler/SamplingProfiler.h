@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SamplingProfiler_h
+#define SamplingProfiler_h
+
+#if ENABLE(SAMPLING_PROFILER)
+
+#include <wtf/FastAllocBase.h>
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <wtf/text/CString.h>
+#include <wtf/text/StringHash.h>
+#include <wtf/text/WTFString.h>
+
+namespace JSC {
+
+    class CodeBlock;
+    class JSGlobalData;
+
+    struct SamplingProfilerStatistics {
+        SamplingProfilerStatistics()
+            : samples(0)
+            , idleSamples(0)
+            , truncatedSamples(0)
+        {
+        }
+
+        unsigned samples;
+        unsigned idleSamples; // No JavaScript on the stack.
+        unsigned truncatedSamples; // Stack walk stopped at an implausible frame or at maxStackDepth.
+    };
+
+    // Periodically samples the JavaScript call stack of the thread that runs a
+    // JSGlobalData. A background thread suspends that thread, walks the
+    // CallFrames from topCallFrame, interpreter and JIT frames alike, and
+    // resumes it. Nothing is allocated while the thread is suspended: frames
+    // are recorded as indices into a table of names that the JavaScript
+    // thread fills in for the live CodeBlocks when the profiler starts, and
+    // for every CodeBlock it creates while the profiler runs.
+    class SamplingProfiler {
+        WTF_MAKE_NONCOPYABLE(SamplingProfiler); WTF_MAKE_FAST_ALLOCATED;
+    public:
+        static const unsigned defaultIntervalInMilliseconds = 10;
+        static const size_t maxStackDepth = 256;
+
+        SamplingProfiler(JSGlobalData&);
+        ~SamplingProfiler();
+
+        // Only called while the profiler runs, so that an idle profiler costs
+        // nothing per CodeBlock.
+        void didCreateCodeBlock(CodeBlock*);
+        void willDestroyCodeBlock(CodeBlock*);
+
+        // Must be called on the thread that runs the JSGlobalData.
+        bool start(unsigned intervalInMilliseconds = defaultIntervalInMilliseconds);
+        void stop();
+        bool isRunning() const { return m_samplerThread; }
+
+        // One "outermost;...;innermost count" line per distinct stack, the
+        // collapsed format read by flamegraph.pl and most flame graph viewers.
+        CString collapsedStacks();
+        void clearSamples();
+
+        SamplingProfilerStatistics statistics();
+
+    private:
+        enum { UnknownFrame, NativeFrame };
+
+        struct CodeBlockRegistrar;
+        void addCodeBlock(CodeBlock*);
+
+        static void* samplerThreadStartFunc(void*);
+        void samplerThreadMain();
+        void takeSample();
+
+        unsigned frameIndex(CodeBlock*);
+
+        JSGlobalData& m_globalData;
+
+        // Guards everything the sampler thread reads, so that it never
+        // suspends the JavaScript thread in the middle of an update.
+        Mutex m_lock;
+        HashMap<CodeBlock*, unsigned> m_codeBlocks; // Only filled in while the profiler runs.
+        Vector<String> m_frameNames; // Touched by the JavaScript thread only.
+        HashMap<String, unsigned> m_frameIndices;
+        Vector<unsigned> m_samples; // Per sample: the depth, then frame indices from the innermost frame out.
+        SamplingProfilerStatistics m_statistics;
+
+        ThreadIdentifier m_samplerThread;
+        void* m_targetThread;
+        unsigned m_interval;
+        Mutex m_stopLock;
+        ThreadCondition m_stopCondition;
+        bool m_shouldStop;
+    };
+
+} // namespace JSC
+
+#endif // ENABLE(SAMPLING_PROFILER)
+
+#endif // SamplingProfiler_h
@@ -286,7 +286,10 @@ JSObject* ProgramExecutable::compileInternal(ExecState* exec, ScopeChainNode* sc
     JSObject* exception = 0;
     JSGlobalData* globalData = &exec->globalData();
     JSGlobalObject* lexicalGlobalObject = exec->lexicalGlobalObject();
-    RefPtr<ProgramNode> programNode = globalData->parser->parse<ProgramNode>(lexicalGlobalObject, lexicalGlobalObject->debugger(), exec, m_source, 0, isStrictMode() ? JSParseStrict : JSParseNormal, &exception);
+    // Large scripts, typically bundles, mostly declare functions that are never
+    // called. Skipping their bodies defers syntax errors in them to the first call.
+    JSParserLaziness laziness = m_source.length() >= Parser::minimumSourceLengthToParseLazily && !lexicalGlobalObject->debugger() ? JSParseLazily : JSParseEagerly;
+    RefPtr<ProgramNode> programNode = globalData->parser->parse<ProgramNode>(lexicalGlobalObject, lexicalGlobalObject->debugger(), exec, m_source, 0, isStrictMode() ? JSParseStrict : JSParseNormal, &exception, laziness);
     if (!programNode) {
         ASSERT(exception);
         return exception;
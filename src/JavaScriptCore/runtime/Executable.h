@@ -322,6 +322,11 @@ namespace JSC {
         void jettisonOptimizedCode(JSGlobalData&);
 #endif
 
+        bool isGenerated() const
+        {
+            return m_evalCodeBlock;
+        }
+
         EvalCodeBlock& generatedBytecode()
         {
             ASSERT(m_evalCodeBlock);
@@ -391,6 +396,11 @@ namespace JSC {
         void jettisonOptimizedCode(JSGlobalData&);
 #endif
 
+        bool isGenerated() const
+        {
+            return m_programCodeBlock;
+        }
+
         ProgramCodeBlock& generatedBytecode()
         {
             ASSERT(m_programCodeBlock);
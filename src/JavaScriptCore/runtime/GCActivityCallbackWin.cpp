@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "GCActivityCallback.h"
+
+#include "APIShims.h"
+#include "Heap.h"
+#include "JSGlobalData.h"
+#include <windows.h>
+#include <wtf/HashMap.h>
+#include <wtf/MainThread.h>
+#include <wtf/StdLibExtras.h>
+
+#if !OS(WINDOWS)
+#error "This file should only be used on Windows."
+#endif
+
+namespace JSC {
+
+// Blocks the last collection left unswept are swept in short slices from a
+// thread timer. WM_TIMER is only delivered once the message queue is empty,
+// so the slices run while the thread is otherwise idle.
+static const UINT sweepTimerInterval = USER_TIMER_MINIMUM; // milliseconds
+static const double sweepSliceTime = 0.002; // seconds
+
+struct DefaultGCActivityCallbackPlatformData {
+    static void CALLBACK trigger(HWND, UINT, UINT_PTR, DWORD);
+
+    void start();
+    void stop();
+
+    Heap* heap;
+    UINT_PTR timer;
+};
+
+typedef HashMap<UINT_PTR, DefaultGCActivityCallbackPlatformData*> TimerMap;
+
+static TimerMap& activeTimers()
+{
+    DEFINE_STATIC_LOCAL(TimerMap, timers, ());
+    return timers;
+}
+
+void DefaultGCActivityCallbackPlatformData::start()
+{
+    // A timer without a window belongs to the thread that set it, and only
+    // the main thread is known to pump messages.
+    if (timer || !isMainThread())
+        return;
+
+    timer = ::SetTimer(0, 0, sweepTimerInterval, trigger);
+    if (timer)
+        activeTimers().set(timer, this);
+}
+
+void DefaultGCActivityCallbackPlatformData::stop()
+{
+    if (!timer)
+        return;
+
+    ::KillTimer(0, timer);
+    activeTimers().remove(timer);
+    timer = 0;
+}
+
+void CALLBACK DefaultGCActivityCallbackPlatformData::trigger(HWND, UINT, UINT_PTR timerID, DWORD)
+{
+    DefaultGCActivityCallbackPlatformData* d = activeTimers().get(timerID);
+    if (!d) {
+        ::KillTimer(0, timerID);
+        return;
+    }
+
+    APIEntryShim shim(d->heap->globalData());
+    if (!d->heap->sweepIncrementally(sweepSliceTime))
+        d->stop();
+}
+
+DefaultGCActivityCallback::DefaultGCActivityCallback(Heap* heap)
+    : d(adoptPtr(new DefaultGCActivityCallbackPlatformData))
+{
+    d->heap = heap;
+    d->timer = 0;
+}
+
+DefaultGCActivityCallback::~DefaultGCActivityCallback()
+{
+    d->stop();
+}
+
+void DefaultGCActivityCallback::operator()()
+{
+    d->start();
+}
+
+void DefaultGCActivityCallback::synchronize()
+{
+}
+
+}
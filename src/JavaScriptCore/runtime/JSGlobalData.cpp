@@ -55,6 +55,7 @@
 #endif
 #include "RegExpCache.h"
 #include "RegExpObject.h"
+#include "SamplingProfiler.h"
 #include "StrictEvalActivation.h"
 #include "StrongInlines.h"
 #include <wtf/Threading.h>
@@ -211,6 +212,9 @@ JSGlobalData::JSGlobalData(GlobalDataType globalDataType, ThreadStackType thread
 #endif
 {
     interpreter = new Interpreter;
+#if ENABLE(SAMPLING_PROFILER)
+    samplingProfiler = adoptPtr(new SamplingProfiler(*this));
+#endif
     if (globalDataType == Default)
         m_stack = wtfThreadData().stack();
 
@@ -68,6 +68,9 @@ namespace JSC {
     class NativeExecutable;
     class Parser;
     class RegExpCache;
+#if ENABLE(SAMPLING_PROFILER)
+    class SamplingProfiler;
+#endif
     class Stringifier;
     class Structure;
     class UString;
@@ -223,6 +226,9 @@ namespace JSC {
 
         TimeoutChecker timeoutChecker;
         Terminator terminator;
+#if ENABLE(SAMPLING_PROFILER)
+        OwnPtr<SamplingProfiler> samplingProfiler;
+#endif
         Heap heap;
 
         JSValue exception;
@@ -31,6 +31,7 @@
 #include "ExceptionHelpers.h"
 #include "JSArray.h"
 #include "JSGlobalObject.h"
+#include "JSONStringScan.h"
 #include "LiteralParser.h"
 #include "Local.h"
 #include "LocalScope.h"
@@ -275,8 +276,7 @@ void Stringifier::appendQuotedString(UStringBuilder& builder, const UString& val
     const UChar* data = value.characters();
     for (int i = 0; i < length; ++i) {
         int start = i;
-        while (i < length && (data[i] > 0x1F && data[i] != '"' && data[i] != '\\'))
-            ++i;
+        i = findJSONStringSpecialCharacter(data + i, data + length) - data;
         builder.append(data + start, i - start);
         if (i >= length)
             break;
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSONStringScan_h
+#define JSONStringScan_h
+
+#include <wtf/unicode/Unicode.h>
+
+#if CPU(X86_64) || (CPU(X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define JSON_STRING_SCAN_SSE2 1
+#include <emmintrin.h>
+#if COMPILER(MSVC)
+#include <intrin.h>
+#endif
+#endif
+
+namespace JSC {
+
+// Returns the first control character, double quote or backslash in
+// [start, end), or end if there is none. These are the characters JSON.parse
+// and JSON.stringify cannot copy through unchanged; strings usually have few
+// of them, so they are searched for eight characters at a time where SSE2 is
+// available.
+inline const UChar* findJSONStringSpecialCharacter(const UChar* start, const UChar* end)
+{
+    const UChar* position = start;
+#if JSON_STRING_SCAN_SSE2
+    const __m128i quote = _mm_set1_epi16('"');
+    const __m128i backslash = _mm_set1_epi16('\\');
+    const __m128i lastControlCharacter = _mm_set1_epi16(0x1F);
+    const __m128i zero = _mm_setzero_si128();
+    while (end - position >= 8) {
+        __m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+        // Saturating subtraction leaves zero exactly for characters up to 0x1F.
+        __m128i isControl = _mm_cmpeq_epi16(_mm_subs_epu16(characters, lastControlCharacter), zero);
+        __m128i isSpecial = _mm_or_si128(isControl, _mm_or_si128(_mm_cmpeq_epi16(characters, quote), _mm_cmpeq_epi16(characters, backslash)));
+        unsigned mask = _mm_movemask_epi8(isSpecial);
+        if (mask) {
+#if COMPILER(MSVC)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+#else
+            unsigned index = __builtin_ctz(mask);
+#endif
+            return position + index / 2;
+        }
+        position += 8;
+    }
+#endif
+    while (position < end && *position > 0x1F && *position != '"' && *position != '\\')
+        ++position;
+    return position;
+}
+
+} // namespace JSC
+
+#endif // JSONStringScan_h
@@ -27,6 +27,7 @@
 #include "LiteralParser.h"
 
 #include "JSArray.h"
+#include "JSONStringScan.h"
 #include "JSString.h"
 #include "Lexer.h"
 #include "StrongInlines.h"
@@ -283,8 +284,14 @@ template <LiteralParser::ParserMode mode, UChar terminator> inline LiteralParser
     UStringBuilder builder;
     do {
         runStart = m_ptr;
-        while (m_ptr < m_end && isSafeStringCharacter<mode, terminator>(*m_ptr))
-            ++m_ptr;
+        if (mode == StrictJSON && terminator == '"') {
+            m_ptr = findJSONStringSpecialCharacter(m_ptr, m_end);
+            while (m_ptr < m_end && *m_ptr == '\t')
+                m_ptr = findJSONStringSpecialCharacter(m_ptr + 1, m_end);
+        } else {
+            while (m_ptr < m_end && isSafeStringCharacter<mode, terminator>(*m_ptr))
+                ++m_ptr;
+        }
         if (builder.length())
             builder.append(runStart, m_ptr - runStart);
         if ((mode != NonStrictJSON) && m_ptr < m_end && *m_ptr == '\\') {
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Checks findJSONStringSpecialCharacter() against the plain character loop
+// it replaces, for every start alignment, every length up to two vectors
+// plus a 16 character tail, and a special character at every position.
+
+#include "config.h"
+#include "JSONStringScan.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace JSC;
+
+static const UChar* findSpecialCharacterSlow(const UChar* start, const UChar* end)
+{
+    const UChar* position = start;
+    while (position < end && *position > 0x1F && *position != '"' && *position != '\\')
+        ++position;
+    return position;
+}
+
+// Characters that must stop the scan.
+static const UChar specialCharacters[] = {
+    '\t', '"', '\\', 0x00, 0x01, '\b', '\n', '\f', '\r', 0x1B, 0x1F,
+};
+
+// Characters that must not, including ones whose low or high byte matches a
+// special character and ones that would look negative to a signed compare.
+static const UChar plainCharacters[] = {
+    ' ', 'a', '~', 0x7F, 0x80, 0xFF, 0x0100, 0x0109, 0x0122, 0x015C, 0x0920, 0x2200,
+    0x5C00, 0x1F00, 0x7FFF, 0x8000, 0x8022, 0xD800, 0xFFE0, 0xFFFF,
+};
+
+static const int maxAlignment = 8;
+static const int maxLength = 8 * 2 + 16;
+
+static int failures = 0;
+
+static void check(const UChar* start, int length, const char* description)
+{
+    const UChar* end = start + length;
+    const UChar* expected = findSpecialCharacterSlow(start, end);
+    const UChar* actual = findJSONStringSpecialCharacter(start, end);
+    if (actual == expected)
+        return;
+
+    if (++failures <= 20) {
+        printf("FAIL %s: alignment %d, length %d, expected %d, got %d\n", description,
+            static_cast<int>((reinterpret_cast<size_t>(start) / sizeof(UChar)) % maxAlignment), length,
+            static_cast<int>(expected - start), static_cast<int>(actual - start));
+    }
+}
+
+static void fillPlain(UChar* characters, int length, unsigned seed)
+{
+    const int plainCount = sizeof(plainCharacters) / sizeof(plainCharacters[0]);
+    for (int i = 0; i < length; ++i)
+        characters[i] = plainCharacters[(seed + i * 7) % plainCount];
+}
+
+int main(int, char**)
+{
+    // A 16 byte aligned buffer; start + alignment covers every offset within a vector.
+    union {
+        double align[(maxAlignment + maxLength + 8) * sizeof(UChar) / sizeof(double) + 1];
+        UChar characters[maxAlignment + maxLength + 8];
+    } buffer;
+    const int specialCount = sizeof(specialCharacters) / sizeof(specialCharacters[0]);
+    int cases = 0;
+
+    for (int alignment = 0; alignment < maxAlignment; ++alignment) {
+        UChar* start = buffer.characters + alignment;
+        for (int length = 0; length <= maxLength; ++length) {
+            fillPlain(buffer.characters, maxAlignment + maxLength + 8, alignment + length);
+            check(start, length, "no special character");
+            ++cases;
+
+            for (int position = 0; position < length; ++position) {
+                for (int i = 0; i < specialCount; ++i) {
+                    fillPlain(buffer.characters, maxAlignment + maxLength + 8, position + i);
+                    start[position] = specialCharacters[i];
+                    check(start, length, "one special character");
+
+                    // A second one further on must not hide the first.
+                    if (position + 1 < length) {
+                        start[length - 1] = specialCharacters[(i + 1) % specialCount];
+                        check(start, length, "two special characters");
+                        ++cases;
+                    }
+                    ++cases;
+                }
+            }
+
+            // A special character just past the end must not be found.
+            fillPlain(buffer.characters, maxAlignment + maxLength + 8, length);
+            start[length] = '"';
+            check(start, length, "special character past the end");
+            ++cases;
+        }
+    }
+
+    // Every other character value, one at a time, in each lane of a vector and in the tail.
+    for (unsigned value = 0; value <= 0xFFFF; ++value) {
+        for (int position = 0; position < 12; ++position) {
+            fillPlain(buffer.characters, maxAlignment + maxLength + 8, value);
+            buffer.characters[position] = static_cast<UChar>(value);
+            check(buffer.characters, 12, "single character value");
+            ++cases;
+        }
+    }
+
+    // Random strings mixing plain and special characters.
+    srand(1);
+    for (int i = 0; i < 100000; ++i) {
+        int alignment = rand() % maxAlignment;
+        int length = rand() % (maxLength + 1);
+        UChar* start = buffer.characters + alignment;
+        for (int j = 0; j < length; ++j)
+            start[j] = (rand() % 64) ? static_cast<UChar>(0x20 + rand() % 0xFFE0) : static_cast<UChar>(rand() % 0x20);
+        check(start, length, "random");
+        ++cases;
+    }
+
+#if JSON_STRING_SCAN_SSE2
+    const char* implementation = "SSE2";
+#else
+    const char* implementation = "scalar";
+#endif
+    printf("%d cases, %d failures (%s)\n", cases, failures, implementation);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
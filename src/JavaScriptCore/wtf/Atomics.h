@@ -116,6 +116,21 @@ inline int atomicDecrement(int volatile* addend) { return __gnu_cxx::__exchange_
 
 #endif
 
+#if ENABLE(COMPARE_AND_SWAP)
+// Stores newValue if *location still holds expected. Returns whether it did.
+#if OS(WINDOWS)
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue)
+{
+    return InterlockedCompareExchange(reinterpret_cast<long volatile*>(location), static_cast<long>(newValue), static_cast<long>(expected)) == static_cast<long>(expected);
+}
+#elif COMPILER(GCC)
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue)
+{
+    return __sync_bool_compare_and_swap(location, expected, newValue);
+}
+#endif
+#endif
+
 } // namespace WTF
 
 #if USE(LOCKFREE_THREADSAFEREFCOUNTED)
@@ -123,4 +138,8 @@ using WTF::atomicDecrement;
 using WTF::atomicIncrement;
 #endif
 
+#if ENABLE(COMPARE_AND_SWAP)
+using WTF::weakCompareAndSwap;
+#endif
+
 #endif // Atomics_h
@@ -19,6 +19,7 @@
 #ifndef Bitmap_h
 #define Bitmap_h
 
+#include "Atomics.h"
 #include "FixedArray.h"
 #include "StdLibExtras.h"
 #include <stdint.h>
@@ -37,6 +38,7 @@ public:
     bool get(size_t) const;
     void set(size_t);
     bool testAndSet(size_t);
+    bool concurrentTestAndSet(size_t);
     bool testAndClear(size_t);
     size_t nextPossiblyUnset(size_t) const;
     void clear(size_t);
@@ -88,6 +90,25 @@ inline bool Bitmap<size>::testAndSet(size_t n)
     return result;
 }
 
+template<size_t size>
+inline bool Bitmap<size>::concurrentTestAndSet(size_t n)
+{
+#if ENABLE(COMPARE_AND_SWAP)
+    WordType mask = one << (n % wordSize);
+    size_t index = n / wordSize;
+    volatile WordType* wordPtr = bits.data() + index;
+    WordType oldValue;
+    do {
+        oldValue = *wordPtr;
+        if (oldValue & mask)
+            return true;
+    } while (!weakCompareAndSwap(wordPtr, oldValue, oldValue | mask));
+    return false;
+#else
+    return testAndSet(n);
+#endif
+}
+
 template<size_t size>
 inline bool Bitmap<size>::testAndClear(size_t n)
 {
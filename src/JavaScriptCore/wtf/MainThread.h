@@ -34,6 +34,10 @@
 
 #include <stdint.h>
 
+#if OS(WINDOWS)
+typedef struct HWND__* HWND;
+#endif
+
 namespace WTF {
 
 typedef uint32_t ThreadIdentifier;
@@ -55,6 +59,12 @@ void initializeMainThreadPlatform();
 void scheduleDispatchFunctionsOnMainThread();
 void dispatchFunctionsFromMainThread();
 
+#if OS(WINDOWS)
+// The message-only window scheduleDispatchFunctionsOnMainThread() posts to, for
+// embedders that pump the main thread's messages themselves.
+HWND threadingWindowHandle();
+#endif
+
 #if PLATFORM(MAC)
 // This version of initializeMainThread sets up the main thread as corresponding
 // to the process's main thread, and not necessarily the thread that calls this
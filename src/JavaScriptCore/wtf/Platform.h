@@ -818,6 +818,11 @@
 #define ENABLE_SAMPLING_THREAD 1
 #endif
 
+/* The sampling profiler reads the call stack of a suspended JavaScript thread. */
+#if !defined(ENABLE_SAMPLING_PROFILER) && OS(WINDOWS)
+#define ENABLE_SAMPLING_PROFILER 1
+#endif
+
 #if !defined(ENABLE_GEOLOCATION)
 #define ENABLE_GEOLOCATION 0
 #endif
@@ -900,6 +905,15 @@
 #define ENABLE_SIMPLE_HEAP_PROFILING 0
 #endif
 
+#if !defined(ENABLE_COMPARE_AND_SWAP) && ((OS(WINDOWS) && !OS(WINCE)) || (COMPILER(GCC) && (CPU(X86) || CPU(X86_64))))
+#define ENABLE_COMPARE_AND_SWAP 1
+#endif
+
+/* Drain the GC mark stack on helper threads as well as the collecting one. */
+#if !defined(ENABLE_PARALLEL_GC) && ENABLE(COMPARE_AND_SWAP)
+#define ENABLE_PARALLEL_GC 1
+#endif
+
 /* Counts uses of write barriers using sampling counters. Be sure to also
    set ENABLE_SAMPLING_COUNTERS to 1. */
 #if !defined(ENABLE_WRITE_BARRIER_PROFILING)
@@ -38,7 +38,7 @@
 
 namespace WTF {
 
-static HWND threadingWindowHandle;
+static HWND threadingWindow;
 static UINT threadingFiredMessage;
 const LPCWSTR kThreadingWindowClassName = L"ThreadingWindowClass";
 
@@ -53,7 +53,7 @@ LRESULT CALLBACK ThreadingWindowWndProc(HWND hWnd, UINT message, WPARAM wParam,
 
 void initializeMainThreadPlatform()
 {
-    if (threadingWindowHandle)
+    if (threadingWindow)
         return;
 
     HWND hWndParent = 0;
@@ -74,7 +74,7 @@ void initializeMainThreadPlatform()
     hWndParent = HWND_MESSAGE;
 #endif
 
-    threadingWindowHandle = CreateWindow(kThreadingWindowClassName, 0, 0,
+    threadingWindow = CreateWindow(kThreadingWindowClassName, 0, 0,
        CW_USEDEFAULT, 0, CW_USEDEFAULT, 0, hWndParent, 0, 0, 0);
     threadingFiredMessage = RegisterWindowMessage(L"com.apple.WebKit.MainThreadFired");
 
@@ -83,8 +83,13 @@ void initializeMainThreadPlatform()
 
 void scheduleDispatchFunctionsOnMainThread()
 {
-    ASSERT(threadingWindowHandle);
-    PostMessage(threadingWindowHandle, threadingFiredMessage, 0, 0);
+    ASSERT(threadingWindow);
+    PostMessage(threadingWindow, threadingFiredMessage, 0, 0);
+}
+
+HWND threadingWindowHandle()
+{
+    return threadingWindow;
 }
 
 } // namespace WTF
@@ -149,6 +149,7 @@
 #undef WTF_USE_CG
 #define WTF_USE_CAIRO 1
 #define WTF_USE_CURL 1
+#define WTF_USE_CURL_MULTI_SOCKET 1
 #ifndef _WINSOCKAPI_
 #define _WINSOCKAPI_ // Prevent inclusion of winsock.h in windows.h
 #endif
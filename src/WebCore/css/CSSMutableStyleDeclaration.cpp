@@ -510,7 +510,7 @@ void CSSMutableStyleDeclaration::setNeedsStyleRecalc()
 {
     if (m_node) {
         if (isInlineStyleDeclaration()) {
-            m_node->setNeedsStyleRecalc(InlineStyleChange);
+            m_node->setNeedsStyleRecalc(LocalStyleChange);
             static_cast<StyledElement*>(m_node)->invalidateStyleAttribute();
             if (m_node->document())
                 InspectorInstrumentation::didInvalidateStyleAttr(m_node->document(), m_node);
@@ -112,6 +112,7 @@
 #include "WebKitFontFamilyNames.h"
 #include "XMLNames.h"
 #include <wtf/StdLibExtras.h>
+#include <wtf/StringHasher.h>
 #include <wtf/Vector.h>
 
 #if ENABLE(DASHBOARD_SUPPORT)
@@ -338,6 +339,8 @@ CSSStyleSelector::CSSStyleSelector(Document* document, StyleSheetList* styleShee
                                    CSSStyleSheet* pageUserSheet, const Vector<RefPtr<CSSStyleSheet> >* pageGroupUserSheets, const Vector<RefPtr<CSSStyleSheet> >* documentUserSheets,
                                    bool strictParsing, bool matchAuthorAndUserStyles)
     : m_backgroundData(BackgroundFillLayer)
+    , m_matchedDeclarationCacheAdditionsSinceLastSweep(0)
+    , m_appliedInheritValue(false)
     , m_checker(document, strictParsing)
     , m_element(0)
     , m_styledElement(0)
@@ -468,6 +471,9 @@ CSSStyleSelector::Features::Features()
 
 CSSStyleSelector::Features::~Features()
 {
+    deleteAllValues(classInvalidationSets);
+    deleteAllValues(idInvalidationSets);
+    deleteAllValues(attributeInvalidationSets);
 }
 
 static CSSStyleSheet* parseUASheet(const String& str)
@@ -1213,6 +1219,7 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* element, Rend
 
     m_style = RenderStyle::create();
 
+    bool hasParentStyle = m_parentStyle;
     if (m_parentStyle)
         m_style->inheritFrom(m_parentStyle);
     else {
@@ -1238,6 +1245,15 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* element, Rend
     else
         matchAllRules(matchResult);
 
+    // Inline style can change without the style selector being rebuilt. The
+    // root element, SVG elements and shadow boundaries are styled with side
+    // effects or adjustments the cache does not capture.
+    matchResult.isCacheable = hasParentStyle && m_rootElementStyle
+        && element != element->document()->documentElement()
+        && !element->isSVGElement()
+        && !isAtShadowBoundary(element)
+        && !(m_styledElement && m_styledElement->inlineStyleDecl());
+
     applyMatchedDeclarations(matchResult);
 
     // Clean up our style object's display and text decorations (among other fixups).
@@ -1968,11 +1984,102 @@ static inline void collectFeaturesFromSelector(CSSStyleSelector::Features& featu
     }
 }
 
+static CSSStyleSelector::InvalidationSet* ensureInvalidationSet(CSSStyleSelector::InvalidationSetMap& map, AtomicStringImpl* key)
+{
+    pair<CSSStyleSelector::InvalidationSetMap::iterator, bool> result = map.add(key, 0);
+    if (result.second)
+        result.first->second = new CSSStyleSelector::InvalidationSet;
+    return result.first->second;
+}
+
+// Calls the functor with the invalidation set of every class, id and attribute
+// the simple selector tests, including those inside :not() and :-webkit-any().
+template <typename Functor>
+static void forEachInvalidationSet(CSSStyleSelector::Features& features, const CSSSelector* selector, Functor& functor)
+{
+    if (selector->m_match == CSSSelector::Class && !selector->value().isEmpty())
+        functor(ensureInvalidationSet(features.classInvalidationSets, selector->value().impl()));
+    else if (selector->m_match == CSSSelector::Id && !selector->value().isEmpty())
+        functor(ensureInvalidationSet(features.idInvalidationSets, selector->value().impl()));
+    if (selector->isAttributeSelector())
+        functor(ensureInvalidationSet(features.attributeInvalidationSets, selector->attribute().localName().impl()));
+
+    if (CSSSelectorList* selectorList = selector->selectorList()) {
+        for (const CSSSelector* subSelector = selectorList->first(); subSelector; subSelector = CSSSelectorList::next(subSelector)) {
+            for (const CSSSelector* simpleSelector = subSelector; simpleSelector; simpleSelector = simpleSelector->tagHistory())
+                forEachInvalidationSet(features, simpleSelector, functor);
+        }
+    }
+}
+
+namespace {
+
+struct InvalidateSelf {
+    void operator()(CSSStyleSelector::InvalidationSet* invalidationSet) { invalidationSet->invalidatesSelf = true; }
+};
+
+// The subject of a selector is described by one of its id, classes or tag
+// name, which any element it matches must have.
+struct InvalidateDescendants {
+    InvalidateDescendants() : id(0), className(0), tagName(0), needsFullStyleChange(false) { }
+
+    void operator()(CSSStyleSelector::InvalidationSet* invalidationSet)
+    {
+        if (needsFullStyleChange || (!id && !className && !tagName))
+            invalidationSet->needsFullStyleChange = true;
+        else if (id)
+            invalidationSet->descendantIds.add(id);
+        else if (className)
+            invalidationSet->descendantClasses.add(className);
+        else
+            invalidationSet->descendantTagNames.add(tagName);
+    }
+
+    AtomicStringImpl* id;
+    AtomicStringImpl* className;
+    AtomicStringImpl* tagName;
+    bool needsFullStyleChange;
+};
+
+} // namespace
+
+static void collectInvalidationSetsFromSelector(CSSStyleSelector::Features& features, const CSSSelector* selector)
+{
+    // Features of the rightmost compound selector only affect the element itself.
+    InvalidateSelf invalidateSelf;
+    InvalidateDescendants invalidateDescendants;
+    for (; selector; selector = selector->tagHistory()) {
+        forEachInvalidationSet(features, selector, invalidateSelf);
+        if (selector->m_match == CSSSelector::Id && !selector->value().isEmpty())
+            invalidateDescendants.id = selector->value().impl();
+        else if (selector->m_match == CSSSelector::Class && !selector->value().isEmpty())
+            invalidateDescendants.className = selector->value().impl();
+        if (selector->tag().localName() != starAtom)
+            invalidateDescendants.tagName = selector->tag().localName().impl();
+        if (selector->relation() != CSSSelector::SubSelector)
+            break;
+    }
+    if (!selector)
+        return;
+
+    // Features further left affect descendants, except that a sibling or shadow
+    // combinator takes anything left of it out of the element's subtree.
+    CSSSelector::Relation relation = selector->relation();
+    for (selector = selector->tagHistory(); selector; selector = selector->tagHistory()) {
+        if (relation != CSSSelector::Descendant && relation != CSSSelector::Child)
+            invalidateDescendants.needsFullStyleChange = true;
+        forEachInvalidationSet(features, selector, invalidateDescendants);
+        if (selector->relation() != CSSSelector::SubSelector)
+            relation = selector->relation();
+    }
+}
+
 static void collectFeaturesFromList(CSSStyleSelector::Features& features, const Vector<RuleData>& rules)
 {
     unsigned size = rules.size();
     for (unsigned i = 0; i < size; ++i) {
         const RuleData& ruleData = rules[i];
+        collectInvalidationSetsFromSelector(features, ruleData.selector());
         bool foundSiblingSelector = false;
         for (CSSSelector* selector = ruleData.selector(); selector; selector = selector->tagHistory()) {
             collectFeaturesFromSelector(features, selector);
@@ -2138,8 +2245,117 @@ void CSSStyleSelector::applyDeclarations(bool isImportant, int startIndex, int e
         applyDeclaration<applyFirst>(m_matchedDecls[i].styleDeclaration, isImportant);
 }
 
+static const unsigned matchedDeclarationCacheAdditionsBetweenSweeps = 100;
+
+unsigned CSSStyleSelector::computeMatchedDeclarationHash() const
+{
+    StringHasher hasher;
+    for (size_t i = 0; i < m_matchedDecls.size(); ++i) {
+        unsigned declarationHash = PtrHash<CSSMutableStyleDeclaration*>::hash(m_matchedDecls[i].styleDeclaration) ^ m_matchedDecls[i].linkMatchType;
+        hasher.addCharacters(static_cast<UChar>(declarationHash), static_cast<UChar>(declarationHash >> 16));
+    }
+    return hasher.hash();
+}
+
+const CSSStyleSelector::MatchedDeclarationCacheItem* CSSStyleSelector::findFromMatchedDeclarationCache(unsigned hash, const MatchResult& matchResult) const
+{
+    MatchedDeclarationCache::const_iterator it = m_matchedDeclarationCache.find(hash);
+    if (it == m_matchedDeclarationCache.end())
+        return 0;
+    const MatchedDeclarationCacheItem& cacheItem = it->second;
+
+    size_t size = m_matchedDecls.size();
+    if (size != cacheItem.declarations.size() || matchResult != cacheItem.matchResult)
+        return 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (m_matchedDecls[i].styleDeclaration != cacheItem.declarations[i].get() || m_matchedDecls[i].linkMatchType != cacheItem.linkMatchTypes[i])
+            return 0;
+    }
+
+    // Only inherited data is passed down from the parent, unless one of the
+    // declarations explicitly inherits a property that is not inherited by default.
+    if (!m_parentStyle->inheritedDataShared(cacheItem.parentRenderStyle.get()))
+        return 0;
+    if (cacheItem.usesInheritValue && !m_parentStyle->nonInheritedDataShared(cacheItem.parentRenderStyle.get()))
+        return 0;
+
+    // Link colors depend on the link state, and rem units on the root element's font.
+    const RenderStyle* cachedStyle = cacheItem.renderStyle.get();
+    if (m_style->isLink() != cachedStyle->isLink() || m_style->insideLink() != cachedStyle->insideLink())
+        return 0;
+    if (m_rootElementStyle != cacheItem.rootElementStyle && m_rootElementStyle->fontDescription() != cacheItem.rootElementStyle->fontDescription())
+        return 0;
+
+    return &cacheItem;
+}
+
+void CSSStyleSelector::addToMatchedDeclarationCache(unsigned hash, const MatchResult& matchResult)
+{
+    // Unique styles depend on the element itself, and styles with an appearance
+    // are adjusted using the UA border and background captured while applying.
+    if (m_style->unique() || m_style->hasAppearance())
+        return;
+
+    if (++m_matchedDeclarationCacheAdditionsSinceLastSweep >= matchedDeclarationCacheAdditionsBetweenSweeps) {
+        sweepMatchedDeclarationCache();
+        m_matchedDeclarationCacheAdditionsSinceLastSweep = 0;
+    }
+
+    // A style sharing the cached data groups must not end up with pending images
+    // that nobody will load, so load them before taking the copy.
+    loadPendingImages();
+    m_pendingImageProperties.clear();
+
+    MatchedDeclarationCacheItem cacheItem;
+    size_t size = m_matchedDecls.size();
+    cacheItem.declarations.reserveInitialCapacity(size);
+    cacheItem.linkMatchTypes.reserveInitialCapacity(size);
+    for (size_t i = 0; i < size; ++i) {
+        cacheItem.declarations.uncheckedAppend(m_matchedDecls[i].styleDeclaration);
+        cacheItem.linkMatchTypes.uncheckedAppend(m_matchedDecls[i].linkMatchType);
+    }
+    cacheItem.matchResult = matchResult;
+    // The styles are cloned because the originals may still be modified. The
+    // clones are only holders for the data groups and are never used as-is.
+    cacheItem.renderStyle = RenderStyle::clone(m_style.get());
+    cacheItem.parentRenderStyle = RenderStyle::clone(m_parentStyle);
+    cacheItem.rootElementStyle = m_rootElementStyle;
+    cacheItem.usesInheritValue = m_appliedInheritValue;
+    m_matchedDeclarationCache.set(hash, cacheItem);
+}
+
+void CSSStyleSelector::sweepMatchedDeclarationCache()
+{
+    // Declarations only referenced by the cache belong to removed rules or
+    // elements, so their entries can never match again.
+    Vector<unsigned, 16> toRemove;
+    MatchedDeclarationCache::iterator end = m_matchedDeclarationCache.end();
+    for (MatchedDeclarationCache::iterator it = m_matchedDeclarationCache.begin(); it != end; ++it) {
+        const Vector<RefPtr<CSSMutableStyleDeclaration> >& declarations = it->second.declarations;
+        for (size_t i = 0; i < declarations.size(); ++i) {
+            if (declarations[i]->hasOneRef()) {
+                toRemove.append(it->first);
+                break;
+            }
+        }
+    }
+    for (size_t i = 0; i < toRemove.size(); ++i)
+        m_matchedDeclarationCache.remove(toRemove[i]);
+}
+
 void CSSStyleSelector::applyMatchedDeclarations(const MatchResult& matchResult)
 {
+    unsigned cacheHash = matchResult.isCacheable ? computeMatchedDeclarationHash() : 0;
+    if (cacheHash) {
+        if (const MatchedDeclarationCacheItem* cacheItem = findFromMatchedDeclarationCache(cacheHash, matchResult)) {
+            const RenderStyle* cachedStyle = cacheItem->renderStyle.get();
+            m_style->inheritFrom(cachedStyle);
+            m_style->copyNonInheritedFrom(cachedStyle);
+            return;
+        }
+    }
+    m_appliedInheritValue = false;
+
     // Now we have all of the matched rules in the appropriate order. Walk the rules and apply
     // high-priority properties first, i.e., those properties that other properties depend on.
     // The order is (1) high-priority not important, (2) high-priority important, (3) normal not important
@@ -2170,6 +2386,9 @@ void CSSStyleSelector::applyMatchedDeclarations(const MatchResult& matchResult)
     applyDeclarations<false>(true, matchResult.firstUARule, matchResult.lastUARule);
     
     ASSERT(!m_fontDirty);
+
+    if (cacheHash)
+        addToMatchedDeclarationCache(cacheHash, matchResult);
 }
 
 void CSSStyleSelector::matchPageRules(RuleSet* rules, bool isLeftPage, bool isFirstPage, const String& pageName)
@@ -2353,6 +2572,10 @@ void CSSStyleSelector::applyProperty(int id, CSSValue *value)
 
     bool isInherit = m_parentNode && valueType == CSSValue::CSS_INHERIT;
     bool isInitial = valueType == CSSValue::CSS_INITIAL || (!m_parentNode && valueType == CSSValue::CSS_INHERIT);
+    if (isInherit) {
+        m_appliedInheritValue = true;
+        m_style->setHasExplicitlyInheritedProperties();
+    }
 
     if (!applyPropertyToRegularStyle() && (!applyPropertyToVisitedLinkStyle() || !isValidVisitedLinkProperty(id))) {
         // Limit the properties that can be applied to only the ones honored by :visited.
@@ -2702,6 +2925,7 @@ void CSSStyleSelector::applyProperty(int id, CSSValue *value)
                 didSet = true;
                 // register the fact that the attribute value affects the style
                 m_features.attrsInRules.add(attr.localName().impl());
+                ensureInvalidationSet(m_features.attributeInvalidationSets, attr.localName().impl())->needsFullStyleChange = true;
                 break;
             }
             case CSSPrimitiveValue::CSS_URI: {
@@ -4888,6 +5112,59 @@ Color CSSStyleSelector::getColorFromPrimitiveValue(CSSPrimitiveValue* primitiveV
     return col;
 }
 
+static bool matchesInvalidationSet(Element* element, const CSSStyleSelector::InvalidationSet* invalidationSet)
+{
+    if (invalidationSet->descendantTagNames.contains(element->localName().impl()))
+        return true;
+    if (element->hasID() && invalidationSet->descendantIds.contains(element->idForStyleResolution().impl()))
+        return true;
+    if (element->hasClass() && element->isStyledElement() && !invalidationSet->descendantClasses.isEmpty()) {
+        const SpaceSplitString& classNames = static_cast<StyledElement*>(element)->classNames();
+        for (size_t i = 0; i < classNames.size(); ++i) {
+            if (invalidationSet->descendantClasses.contains(classNames[i].impl()))
+                return true;
+        }
+    }
+    return false;
+}
+
+void CSSStyleSelector::invalidateStyle(Element* element, const InvalidationSet* invalidationSet)
+{
+    if (!invalidationSet || element->styleChangeType() >= FullStyleChange)
+        return;
+
+    // The view source style sheet uses classes but is not part of m_features.
+    if (invalidationSet->needsFullStyleChange || m_checker.document()->isViewSource()) {
+        element->setNeedsStyleRecalc();
+        return;
+    }
+
+    if (invalidationSet->invalidatesSelf)
+        element->setNeedsStyleRecalc(LocalStyleChange);
+
+    if (invalidationSet->descendantClasses.isEmpty() && invalidationSet->descendantIds.isEmpty() && invalidationSet->descendantTagNames.isEmpty())
+        return;
+    for (Node* node = element->firstChild(); node; node = node->traverseNextNode(element)) {
+        if (node->isElementNode() && matchesInvalidationSet(static_cast<Element*>(node), invalidationSet))
+            node->setNeedsStyleRecalc(LocalStyleChange);
+    }
+}
+
+void CSSStyleSelector::invalidateStyleForClassChange(Element* element, const AtomicString& className)
+{
+    invalidateStyle(element, m_features.classInvalidationSets.get(className.impl()));
+}
+
+void CSSStyleSelector::invalidateStyleForIdChange(Element* element, const AtomicString& id)
+{
+    invalidateStyle(element, m_features.idInvalidationSets.get(id.impl()));
+}
+
+void CSSStyleSelector::invalidateStyleForAttributeChange(Element* element, const AtomicString& attributeName)
+{
+    invalidateStyle(element, m_features.attributeInvalidationSets.get(attributeName.impl()));
+}
+
 bool CSSStyleSelector::hasSelectorForAttribute(const AtomicString &attrname) const
 {
     return m_features.attrsInRules.contains(attrname.impl());
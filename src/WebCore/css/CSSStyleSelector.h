@@ -108,6 +108,10 @@ public:
 
     static PassRefPtr<RenderStyle> styleForDocument(Document*);
 
+    // Needed when something other than the style sheets changes what the
+    // declarations resolve to, like zoom or the document's link colors.
+    void clearMatchedDeclarationCache() { m_matchedDeclarationCache.clear(); }
+
     RenderStyle* style() const { return m_style.get(); }
     RenderStyle* parentStyle() const { return m_parentStyle; }
     RenderStyle* rootElementStyle() const { return m_rootElementStyle; }
@@ -178,6 +182,12 @@ public:
 
     bool hasSelectorForAttribute(const AtomicString&) const;
 
+    // Mark the elements that may need a new style after a class, id or attribute
+    // of the given element was added, removed or changed.
+    void invalidateStyleForClassChange(Element*, const AtomicString& className);
+    void invalidateStyleForIdChange(Element*, const AtomicString& id);
+    void invalidateStyleForAttributeChange(Element*, const AtomicString& attributeName);
+
     CSSFontSelector* fontSelector() const { return m_fontSelector.get(); }
 
     void addViewportDependentMediaQueryResult(const MediaQueryExp*, bool result);
@@ -202,11 +212,28 @@ public:
     bool createFilterOperations(CSSValue* inValue, RenderStyle* inStyle, RenderStyle* rootStyle, FilterOperations& outOperations);
 #endif
 
+    // The elements that may need a new style when a class, id or attribute
+    // changes on an element.
+    struct InvalidationSet {
+        InvalidationSet() : invalidatesSelf(false), needsFullStyleChange(false) { }
+        bool invalidatesSelf;
+        // Set when the feature is used left of a sibling combinator, or when
+        // the descendants it affects have no class, id or tag name in common.
+        bool needsFullStyleChange;
+        HashSet<AtomicStringImpl*> descendantClasses;
+        HashSet<AtomicStringImpl*> descendantIds;
+        HashSet<AtomicStringImpl*> descendantTagNames;
+    };
+    typedef HashMap<AtomicStringImpl*, InvalidationSet*> InvalidationSetMap;
+
     struct Features {
         Features();
         ~Features();
         HashSet<AtomicStringImpl*> idsInRules;
         HashSet<AtomicStringImpl*> attrsInRules;
+        InvalidationSetMap classInvalidationSets;
+        InvalidationSetMap idInvalidationSets;
+        InvalidationSetMap attributeInvalidationSets;
         OwnPtr<RuleSet> siblingRules;
         OwnPtr<RuleSet> uncommonAttributeRules;
         bool usesFirstLineRules;
@@ -226,13 +253,26 @@ private:
     void addMatchedDeclaration(CSSMutableStyleDeclaration*, unsigned linkMatchType = SelectorChecker::MatchAll);
 
     struct MatchResult {
-        MatchResult() : firstUARule(-1), lastUARule(-1), firstAuthorRule(-1), lastAuthorRule(-1), firstUserRule(-1), lastUserRule(-1) { }
+        MatchResult() : firstUARule(-1), lastUARule(-1), firstAuthorRule(-1), lastAuthorRule(-1), firstUserRule(-1), lastUserRule(-1), isCacheable(false) { }
+        bool operator==(const MatchResult& other) const
+        {
+            return firstUARule == other.firstUARule
+                && lastUARule == other.lastUARule
+                && firstAuthorRule == other.firstAuthorRule
+                && lastAuthorRule == other.lastAuthorRule
+                && firstUserRule == other.firstUserRule
+                && lastUserRule == other.lastUserRule
+                && isCacheable == other.isCacheable;
+        }
+        bool operator!=(const MatchResult& other) const { return !(*this == other); }
+
         int firstUARule;
         int lastUARule;
         int firstAuthorRule;
         int lastAuthorRule;
         int firstUserRule;
         int lastUserRule;
+        bool isCacheable;
     };
     void matchAllRules(MatchResult&);
     void matchUARules(MatchResult&);
@@ -314,6 +354,8 @@ private:
 
     bool canShareStyleWithControl(StyledElement*) const;
 
+    void invalidateStyle(Element*, const InvalidationSet*);
+
     void applyProperty(int id, CSSValue*);
     void applyPageSizeProperty(CSSValue*);
     bool pageSizeFromName(CSSPrimitiveValue*, CSSPrimitiveValue*, Length& width, Length& height);
@@ -336,6 +378,30 @@ private:
     };
     Vector<MatchedStyleDeclaration, 64> m_matchedDecls;
 
+    // Applying the same declarations on top of the same inherited data always
+    // gives the same style, so the data groups of an earlier result can be
+    // shared instead of applying every property again.
+    struct MatchedDeclarationCacheItem {
+        // The references keep a declaration from being freed and another one
+        // allocated at the same address while the entry exists.
+        Vector<RefPtr<CSSMutableStyleDeclaration> > declarations;
+        Vector<unsigned> linkMatchTypes;
+        MatchResult matchResult;
+        RefPtr<RenderStyle> renderStyle;
+        RefPtr<RenderStyle> parentRenderStyle;
+        RefPtr<RenderStyle> rootElementStyle;
+        bool usesInheritValue;
+    };
+    typedef HashMap<unsigned, MatchedDeclarationCacheItem> MatchedDeclarationCache;
+    MatchedDeclarationCache m_matchedDeclarationCache;
+    unsigned m_matchedDeclarationCacheAdditionsSinceLastSweep;
+    bool m_appliedInheritValue;
+
+    unsigned computeMatchedDeclarationHash() const;
+    const MatchedDeclarationCacheItem* findFromMatchedDeclarationCache(unsigned hash, const MatchResult&) const;
+    void addToMatchedDeclarationCache(unsigned hash, const MatchResult&);
+    void sweepMatchedDeclarationCache();
+
     // A buffer used to hold the set of matched rules for an element, and a temporary buffer used for
     // merge sorting.
     Vector<const RuleData*, 32> m_matchedRules;
@@ -348,6 +348,10 @@ private:
 
 uint64_t Document::s_globalTreeVersion = 0;
 
+unsigned Document::s_styleRecalcCount = 0;
+unsigned Document::s_restyledElementCount = 0;
+unsigned Document::s_lastRecalcRestyledElementCount = 0;
+
 Document::Document(Frame* frame, const KURL& url, bool isXHTML, bool isHTML)
     : TreeScope(0)
     , m_guardRefCount(0)
@@ -1480,6 +1484,8 @@ void Document::recalcStyle(StyleChange change)
     m_inStyleRecalc = true;
     suspendPostAttachCallbacks();
     RenderWidget::suspendWidgetHierarchyUpdates();
+
+    unsigned restyledElementCountAtStart = s_restyledElementCount;
     
     RefPtr<FrameView> frameView = view();
     if (frameView) {
@@ -1497,6 +1503,10 @@ void Document::recalcStyle(StyleChange change)
     if (change == Force) {
         // style selector may set this again during recalc
         m_hasNodesWithPlaceholderStyle = false;
+
+        // Forced recalcs follow changes the style selector cannot see, like zoom.
+        if (m_styleSelector)
+            m_styleSelector->clearMatchedDeclarationCache();
         
         RefPtr<RenderStyle> documentStyle = CSSStyleSelector::styleForDocument(this);
         StyleChange ch = diff(documentStyle.get(), renderer()->style());
@@ -1528,6 +1538,9 @@ bail_out:
 
     m_inStyleRecalc = false;
     
+    ++s_styleRecalcCount;
+    s_lastRecalcRestyledElementCount = s_restyledElementCount - restyledElementCountAtStart;
+
     // Pseudo element removal and similar may only work with these flags still set. Reset them after the style recalc.
     if (m_styleSelector) {
         m_usesSiblingRules = m_styleSelector->usesSiblingRules();
@@ -541,6 +541,13 @@ public:
 
     void recalcStyle(StyleChange = NoChange);
     bool childNeedsAndNotInStyleRecalc();
+
+    // Counts of style recalcs and of the elements they gave a new style, across all documents.
+    static unsigned styleRecalcCount() { return s_styleRecalcCount; }
+    static unsigned restyledElementCount() { return s_restyledElementCount; }
+    static unsigned lastRecalcRestyledElementCount() { return s_lastRecalcRestyledElementCount; }
+    static void didRestyleElement() { ++s_restyledElementCount; }
+
     virtual void updateStyleIfNeeded();
     void updateLayout();
     void updateLayoutIgnorePendingStylesheets();
@@ -1226,6 +1233,10 @@ private:
 
     uint64_t m_domTreeVersion;
     static uint64_t s_globalTreeVersion;
+
+    static unsigned s_styleRecalcCount;
+    static unsigned s_restyledElementCount;
+    static unsigned s_lastRecalcRestyledElementCount;
     
     HashSet<NodeIterator*> m_nodeIterators;
     HashSet<Range*> m_ranges;
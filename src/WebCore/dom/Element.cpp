@@ -757,12 +757,13 @@ void Element::updateAfterAttributeChanged(Attribute* attr)
     
 void Element::recalcStyleIfNeededAfterAttributeChanged(Attribute* attr)
 {
-    if (document()->attached() && document()->styleSelector()->hasSelectorForAttribute(attr->name().localName()))
-        setNeedsStyleRecalc();
+    if (document()->attached())
+        document()->styleSelector()->invalidateStyleForAttributeChange(this, attr->name().localName());
 }
 
 void Element::idAttributeChanged(Attribute* attr)
 {
+    AtomicString oldId = hasID() && attributeMap() ? idForStyleResolution() : nullAtom;
     setHasID(!attr->isNull());
     if (attributeMap()) {
         if (attr->isNull())
@@ -772,7 +773,19 @@ void Element::idAttributeChanged(Attribute* attr)
         else
             attributeMap()->setIdForStyleResolution(attr->value());
     }
-    setNeedsStyleRecalc();
+
+    if (!document()->attached()) {
+        setNeedsStyleRecalc();
+        return;
+    }
+    const AtomicString& newId = hasID() && attributeMap() ? idForStyleResolution() : nullAtom;
+    if (oldId == newId)
+        return;
+    CSSStyleSelector* styleSelector = document()->styleSelector();
+    if (!oldId.isEmpty())
+        styleSelector->invalidateStyleForIdChange(this, oldId);
+    if (!newId.isEmpty())
+        styleSelector->invalidateStyleForIdChange(this, newId);
 }
     
 // Returns true is the given attribute is an event handler.
@@ -1102,6 +1115,7 @@ void Element::recalcStyle(StyleChange change)
         }
     }
     if (hasParentStyle && (change >= Inherit || needsStyleRecalc())) {
+        Document::didRestyleElement();
         RefPtr<RenderStyle> newStyle = styleForRenderer();
         StyleChange ch = diff(currentStyle.get(), newStyle.get());
         if (ch == Detach || !currentStyle) {
@@ -1179,9 +1193,13 @@ void Element::recalcStyle(StyleChange change)
         bool childAffectedByDirectAdjacentRules = element->renderStyle() ? element->renderStyle()->affectedByDirectAdjacentRules() : previousSiblingHadDirectAdjacentRules;
         if (childAffectedByDirectAdjacentRules || forceCheckOfAnyElementSibling)
             element->setNeedsStyleRecalc();
-        if (change >= Inherit || element->childNeedsStyleRecalc() || element->needsStyleRecalc()) {
+        // A child that explicitly inherits may depend on the non-inherited properties that changed here.
+        StyleChange childChange = change;
+        if (change == NoInherit && element->renderStyle() && element->renderStyle()->hasExplicitlyInheritedProperties())
+            childChange = Inherit;
+        if (childChange >= Inherit || element->childNeedsStyleRecalc() || element->needsStyleRecalc()) {
             parentPusher.push();
-            element->recalcStyle(change);
+            element->recalcStyle(childChange);
         }
         previousSiblingHadDirectAdjacentRules = childAffectedByDirectAdjacentRules;
         forceCheckOfAnyElementSibling = forceCheckOfAnyElementSibling || (childRulesChanged && hasIndirectAdjacentRules);
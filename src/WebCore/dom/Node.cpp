@@ -302,8 +302,8 @@ void Node::stopIgnoringLeaks()
 Node::StyleChange Node::diff(const RenderStyle* s1, const RenderStyle* s2)
 {
     // FIXME: The behavior of this function is just totally wrong.  It doesn't handle
-    // explicit inheritance of non-inherited properties and so you end up not re-resolving
-    // style in cases where you need to.
+    // explicit inheritance of non-inherited properties; Element::recalcStyle works
+    // around that by checking each child's style for explicitly inherited properties.
     StyleChange ch = NoInherit;
     EDisplay display1 = s1 ? s1->display() : NONE;
     bool fl1 = s1 && s1->hasPseudoStyle(FIRST_LETTER);
@@ -86,12 +86,14 @@ typedef int ExceptionCode;
 
 const int nodeStyleChangeShift = 25;
 
+// LocalStyleChange means that only the node itself needs a new style, so its descendants are only
+// updated if inherited properties change. FullStyleChange recomputes the whole subtree.
 // SyntheticStyleChange means that we need to go through the entire style change logic even though
 // no style property has actually changed. It is used to restructure the tree when, for instance,
 // RenderLayers are created or destroyed due to animation changes.
 enum StyleChangeType { 
     NoStyleChange = 0, 
-    InlineStyleChange = 1 << nodeStyleChangeShift, 
+    LocalStyleChange = 1 << nodeStyleChangeShift, 
     FullStyleChange = 2 << nodeStyleChangeShift, 
     SyntheticStyleChange = 3 << nodeStyleChangeShift
 };
@@ -214,6 +214,13 @@ bool StyledElement::mapToEntry(const QualifiedName& attrName, MappedAttributeEnt
 
 void StyledElement::classAttributeChanged(const AtomicString& newClassString)
 {
+    Vector<AtomicString, 8> oldClasses;
+    if (hasClass()) {
+        const SpaceSplitString& classes = classNames();
+        for (size_t i = 0; i < classes.size(); ++i)
+            oldClasses.append(classes[i]);
+    }
+
     const UChar* characters = newClassString.characters();
     unsigned length = newClassString.length();
     unsigned i;
@@ -229,10 +236,35 @@ void StyledElement::classAttributeChanged(const AtomicString& newClassString)
             static_cast<ClassList*>(classList)->reset(newClassString);
     } else if (attributeMap())
         attributeMap()->clearClass();
-    setNeedsStyleRecalc();
+    invalidateStyleForClassChange(oldClasses);
     dispatchSubtreeModifiedEvent();
 }
 
+void StyledElement::invalidateStyleForClassChange(const Vector<AtomicString, 8>& oldClasses)
+{
+    if (!document()->attached()) {
+        setNeedsStyleRecalc();
+        return;
+    }
+
+    // Only classes that were added or removed can change which rules match.
+    CSSStyleSelector* styleSelector = document()->styleSelector();
+    if (hasClass()) {
+        const SpaceSplitString& classes = classNames();
+        for (size_t i = 0; i < classes.size(); ++i) {
+            if (oldClasses.find(classes[i]) == notFound)
+                styleSelector->invalidateStyleForClassChange(this, classes[i]);
+        }
+        for (size_t i = 0; i < oldClasses.size(); ++i) {
+            if (!classes.contains(oldClasses[i]))
+                styleSelector->invalidateStyleForClassChange(this, oldClasses[i]);
+        }
+        return;
+    }
+    for (size_t i = 0; i < oldClasses.size(); ++i)
+        styleSelector->invalidateStyleForClassChange(this, oldClasses[i]);
+}
+
 void StyledElement::parseMappedAttribute(Attribute* attr)
 {
     if (isIdAttributeName(attr->name()))
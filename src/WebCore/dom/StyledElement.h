@@ -88,6 +88,7 @@ protected:
 
 private:
     void createMappedDecl(Attribute*);
+    void invalidateStyleForClassChange(const Vector<AtomicString, 8>& oldClasses);
 
     void createInlineStyleDecl();
     void destroyInlineStyleDecl();
@@ -581,8 +581,11 @@ bool MainResourceLoader::loadNow(ResourceRequest& r)
         handleDataLoadSoon(r);
     else if (shouldLoadEmpty || frameLoader()->client()->representationExistsForURLScheme(url.protocol()))
         handleEmptyLoad(url, !shouldLoadEmpty);
-    else
+    else {
+        // Nothing on the page can load before the document itself.
+        r.setPriority(ResourceLoadPriorityHighest);
         m_handle = ResourceHandle::create(m_frame->loader()->networkingContext(), r, this, false, true);
+    }
 
     return false;
 }
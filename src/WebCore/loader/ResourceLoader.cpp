@@ -56,6 +56,7 @@ PassRefPtr<SharedBuffer> ResourceLoader::resourceData()
 ResourceLoader::ResourceLoader(Frame* frame, ResourceLoaderOptions options)
     : m_frame(frame)
     , m_documentLoader(frame->loader()->activeDocumentLoader())
+    , m_receivedBuffer(0)
     , m_identifier(0)
     , m_reachedTerminalState(false)
     , m_calledWillCancel(false)
@@ -162,6 +163,13 @@ void ResourceLoader::start()
         m_handle = ResourceHandle::create(m_frame->loader()->networkingContext(), m_request, this, m_defersLoading, m_options.sniffContent == SniffContent);
 }
 
+void ResourceLoader::didChangePriority(ResourceLoadPriority loadPriority)
+{
+    m_request.setPriority(loadPriority);
+    if (m_handle)
+        m_handle->didChangePriority(loadPriority);
+}
+
 void ResourceLoader::setDefersLoading(bool defers)
 {
     m_defersLoading = defers;
@@ -200,6 +208,14 @@ void ResourceLoader::addData(const char* data, int length, bool allAtOnce)
         m_resourceData = SharedBuffer::create(data, length);
         return;
     }
+
+    if (m_receivedBuffer && data == m_receivedBuffer->data() && static_cast<unsigned>(length) == m_receivedBuffer->size()) {
+        // Keep a reference to the delivered buffer rather than copying it.
+        if (!m_resourceData)
+            m_resourceData = SharedBuffer::create();
+        m_resourceData->appendSegment(m_receivedBuffer);
+        return;
+    }
         
     if (!m_resourceData)
         m_resourceData = SharedBuffer::create(data, length);
@@ -442,6 +458,19 @@ void ResourceLoader::didReceiveData(ResourceHandle*, const char* data, int lengt
     InspectorInstrumentation::didReceiveResourceData(cookie);
 }
 
+void ResourceLoader::didReceiveBuffer(ResourceHandle*, PassRefPtr<SharedBuffer> buffer, int encodedDataLength)
+{
+    // The client may release this loader while handling the data.
+    RefPtr<ResourceLoader> protector(this);
+    RefPtr<SharedBuffer> receivedBuffer = buffer;
+
+    InspectorInstrumentationCookie cookie = InspectorInstrumentation::willReceiveResourceData(m_frame.get(), identifier());
+    m_receivedBuffer = receivedBuffer.get();
+    didReceiveData(receivedBuffer->data(), receivedBuffer->size(), encodedDataLength, false);
+    m_receivedBuffer = 0;
+    InspectorInstrumentation::didReceiveResourceData(cookie);
+}
+
 void ResourceLoader::didFinishLoading(ResourceHandle*, double finishTime)
 {
     if (!fastMallocSize(documentLoader()->applicationCacheHost()))
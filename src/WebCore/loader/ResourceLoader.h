@@ -65,6 +65,7 @@ namespace WebCore {
         ResourceError cannotShowURLError();
         
         virtual void setDefersLoading(bool);
+        void didChangePriority(ResourceLoadPriority);
 
         void setIdentifier(unsigned long identifier) { m_identifier = identifier; }
         unsigned long identifier() const { return m_identifier; }
@@ -101,6 +102,7 @@ namespace WebCore {
         virtual void didSendData(ResourceHandle*, unsigned long long bytesSent, unsigned long long totalBytesToBeSent);
         virtual void didReceiveResponse(ResourceHandle*, const ResourceResponse&);
         virtual void didReceiveData(ResourceHandle*, const char*, int, int encodedDataLength);
+        virtual void didReceiveBuffer(ResourceHandle*, PassRefPtr<SharedBuffer>, int encodedDataLength);
         virtual void didReceiveCachedMetadata(ResourceHandle*, const char* data, int length) { didReceiveCachedMetadata(data, length); }
         virtual void didFinishLoading(ResourceHandle*, double finishTime);
         virtual void didFail(ResourceHandle*, const ResourceError&);
@@ -172,6 +174,8 @@ namespace WebCore {
         ResourceRequest m_request;
         ResourceRequest m_originalRequest; // Before redirects.
         RefPtr<SharedBuffer> m_resourceData;
+        // The buffer being delivered by didReceiveBuffer(), if any.
+        SharedBuffer* m_receivedBuffer;
         
         unsigned long m_identifier;
 
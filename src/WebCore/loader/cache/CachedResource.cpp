@@ -625,9 +625,11 @@ unsigned CachedResource::overheadSize() const
     
 void CachedResource::setLoadPriority(ResourceLoadPriority loadPriority) 
 { 
-    if (loadPriority == ResourceLoadPriorityUnresolved)
+    if (loadPriority == ResourceLoadPriorityUnresolved || loadPriority == m_loadPriority)
         return;
     m_loadPriority = loadPriority;
+    if (m_request)
+        m_request->didChangePriority(loadPriority);
 }
 
 }
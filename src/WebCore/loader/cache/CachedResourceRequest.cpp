@@ -158,6 +158,11 @@ void CachedResourceRequest::cancel()
     m_loader->cancel();
 }
 
+void CachedResourceRequest::didChangePriority(ResourceLoadPriority loadPriority)
+{
+    m_loader->didChangePriority(loadPriority);
+}
+
 void CachedResourceRequest::didFinishLoading(SubresourceLoader* loader, double)
 {
     if (m_finishing)
@@ -48,6 +48,7 @@ namespace WebCore {
 
         CachedResourceLoader* cachedResourceLoader() const { return m_cachedResourceLoader; }
         void cancel();
+        void didChangePriority(ResourceLoadPriority);
 
     private:
         CachedResourceRequest(CachedResourceLoader*, CachedResource*);
@@ -38,12 +38,20 @@
 #include <parser/SourceProvider.h>
 #endif
 
+#if USE(JSC) && USE(CURL)
+#include "CurlCacheManager.h"
+#include <wtf/SHA1.h>
+#endif
+
 namespace WebCore {
 
 CachedScript::CachedScript(const ResourceRequest& resourceRequest, const String& charset)
     : CachedResource(resourceRequest, Script)
     , m_decoder(TextResourceDecoder::create("application/javascript", charset))
     , m_decodedDataDeletionTimer(this, &CachedScript::decodedDataDeletionTimerFired)
+#if USE(JSC)
+    , m_sourceProviderCacheLoaded(false)
+#endif
 {
     // It's javascript we want.
     // But some websites think their scripts are <some wrong mimetype here>
@@ -53,6 +61,9 @@ CachedScript::CachedScript(const ResourceRequest& resourceRequest, const String&
 
 CachedScript::~CachedScript()
 {
+#if USE(JSC)
+    saveSourceProviderCache();
+#endif
 }
 
 void CachedScript::didAddClient(CachedResourceClient* c)
@@ -117,8 +128,11 @@ void CachedScript::destroyDecodedData()
     m_script = String();
     unsigned extraSize = 0;
 #if USE(JSC)
-    if (m_sourceProviderCache && m_clients.isEmpty())
+    if (m_sourceProviderCache && m_clients.isEmpty()) {
+        saveSourceProviderCache();
         m_sourceProviderCache->clear();
+        m_sourceProviderCacheLoaded = false;
+    }
 
     extraSize = m_sourceProviderCache ? m_sourceProviderCache->byteSize() : 0;
 #endif
@@ -137,9 +151,74 @@ JSC::SourceProviderCache* CachedScript::sourceProviderCache() const
 {   
     if (!m_sourceProviderCache) 
         m_sourceProviderCache = adoptPtr(new JSC::SourceProviderCache); 
+    if (!m_sourceProviderCacheLoaded) {
+        m_sourceProviderCacheLoaded = true;
+        loadSourceProviderCache();
+    }
     return m_sourceProviderCache.get(); 
 }
 
+#if USE(CURL)
+// The function info the parser records is only valid for the exact source it
+// was taken from, so the file starts with a hash of the raw script bytes,
+// their encoding and the version of the encoded format.
+static void computeSourceProviderCacheDigest(const SharedBuffer& data, const String& encoding, Vector<uint8_t, 20>& digest)
+{
+    SHA1 sha1;
+    CString encodingName = encoding.latin1();
+    sha1.addBytes(reinterpret_cast<const uint8_t*>(encodingName.data()), encodingName.length() + 1);
+    unsigned version = JSC::SourceProviderCache::encodedFormatVersion;
+    sha1.addBytes(reinterpret_cast<const uint8_t*>(&version), sizeof(version));
+    sha1.addBytes(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    sha1.computeHash(digest);
+}
+#endif
+
+void CachedScript::loadSourceProviderCache() const
+{
+#if USE(CURL)
+    if (!m_data)
+        return;
+    String path = CurlCacheManager::getInstance().scriptCachePath(url());
+    if (path.isEmpty())
+        return;
+
+    RefPtr<SharedBuffer> buffer = SharedBuffer::createWithContentsOfFile(path);
+    if (!buffer)
+        return;
+    if (m_sourceProviderCacheDigest.isEmpty())
+        computeSourceProviderCacheDigest(*m_data, encoding(), m_sourceProviderCacheDigest);
+    size_t digestSize = m_sourceProviderCacheDigest.size();
+    if (buffer->size() < digestSize || memcmp(buffer->data(), m_sourceProviderCacheDigest.data(), digestSize))
+        return;
+    if (!m_sourceProviderCache->decode(buffer->data() + digestSize, buffer->size() - digestSize))
+        return;
+    const_cast<CachedScript*>(this)->setDecodedSize(decodedSize() + m_sourceProviderCache->byteSize());
+#endif
+}
+
+void CachedScript::saveSourceProviderCache()
+{
+#if USE(CURL)
+    if (!m_sourceProviderCache || !m_sourceProviderCache->hasUnsavedItems() || !m_data)
+        return;
+
+    if (m_sourceProviderCacheDigest.isEmpty())
+        computeSourceProviderCacheDigest(*m_data, encoding(), m_sourceProviderCacheDigest);
+
+    OwnPtr<Vector<char> > buffer = adoptPtr(new Vector<char>);
+    buffer->append(reinterpret_cast<const char*>(m_sourceProviderCacheDigest.data()), m_sourceProviderCacheDigest.size());
+    Vector<char> encoded;
+    m_sourceProviderCache->encode(encoded);
+    buffer->append(encoded.data(), encoded.size());
+
+    // The file is written off the main thread and accounted to the script's
+    // disk cache entry; nothing is written for scripts without one.
+    CurlCacheManager::getInstance().writeScriptCache(url(), buffer.release());
+    m_sourceProviderCache->didSave();
+#endif
+}
+
 void CachedScript::sourceProviderCacheSizeChanged(int delta)
 {
     setDecodedSize(decodedSize() + delta);
@@ -64,12 +64,19 @@ namespace WebCore {
     private:
         void decodedDataDeletionTimerFired(Timer<CachedScript>*);
         virtual PurgePriority purgePriority() const { return PurgeLast; }
+#if USE(JSC)
+        void loadSourceProviderCache() const;
+        void saveSourceProviderCache();
+#endif
 
         String m_script;
         RefPtr<TextResourceDecoder> m_decoder;
         Timer<CachedScript> m_decodedDataDeletionTimer;
 #if USE(JSC)        
         mutable OwnPtr<JSC::SourceProviderCache> m_sourceProviderCache;
+        // Identifies the exact bytes the function info on disk was taken from.
+        mutable Vector<uint8_t, 20> m_sourceProviderCacheDigest;
+        mutable bool m_sourceProviderCacheLoaded;
 #endif
     };
 }
@@ -49,6 +49,7 @@
 #include "HTMLFrameSetElement.h"
 #include "HTMLNames.h"
 #include "HTMLPlugInImageElement.h"
+#include "ImageSource.h"
 #include "InspectorInstrumentation.h"
 #include "OverflowEvent.h"
 #include "RenderArena.h"
@@ -2761,6 +2762,10 @@ void FrameView::paintContents(GraphicsContext* p, const LayoutRect& rect)
     ASSERT(!m_isPainting);
     m_isPainting = true;
 
+    // Images still being decoded off the main thread are left out of this paint
+    // and repainted when they are ready, unless the result is kept as is.
+    ImageSource::PlaceholderScope imagePlaceholderScope(!document->printing() && !m_nodeToDraw);
+
     // m_nodeToDraw is used to draw only one element (and its descendants)
     RenderObject* eltRenderer = m_nodeToDraw ? m_nodeToDraw->renderer() : 0;
     RenderLayer* rootLayer = root->layer();
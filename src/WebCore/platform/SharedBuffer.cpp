@@ -28,6 +28,7 @@
 #include "SharedBuffer.h"
 
 #include "PurgeableBuffer.h"
+#include <algorithm>
 #include <wtf/PassOwnPtr.h>
 
 using namespace std;
@@ -132,6 +133,18 @@ void SharedBuffer::append(const char* data, unsigned length)
     ASSERT(!m_purgeableBuffer);
 
     maybeTransferPlatformData();
+
+    if (!m_sharedSegments.isEmpty()) {
+        // Data appended after a shared segment must stay behind it. Grow the
+        // last segment if we are its only owner, otherwise start a new one.
+        SharedBuffer* lastSegment = m_sharedSegments.last().get();
+        if (lastSegment->hasOneRef() && !lastSegment->hasPurgeableBuffer()) {
+            lastSegment->append(data, length);
+            m_size += length;
+        } else
+            appendSegment(SharedBuffer::create(data, length));
+        return;
+    }
     
     unsigned positionInSegment = offsetInSegment(m_size - m_buffer.size());
     m_size += length;
@@ -170,6 +183,23 @@ void SharedBuffer::append(const Vector<char>& data)
     append(data.data(), data.size());
 }
 
+void SharedBuffer::appendSegment(PassRefPtr<SharedBuffer> prpSegment)
+{
+    ASSERT(!m_purgeableBuffer);
+
+    RefPtr<SharedBuffer> segment = prpSegment;
+    ASSERT(segment != this);
+    unsigned length = segment->size();
+    if (!length)
+        return;
+
+    maybeTransferPlatformData();
+
+    m_sharedSegmentPositions.append(m_size);
+    m_sharedSegments.append(segment.release());
+    m_size += length;
+}
+
 void SharedBuffer::clear()
 {
     clearPlatformData();
@@ -178,6 +208,8 @@ void SharedBuffer::clear()
         freeSegment(m_segments[i]);
 
     m_segments.clear();
+    m_sharedSegments.clear();
+    m_sharedSegmentPositions.clear();
     m_size = 0;
 
     m_buffer.clear();
@@ -197,9 +229,12 @@ PassRefPtr<SharedBuffer> SharedBuffer::copy() const
 
     clone->m_size = m_size;
     clone->m_buffer.reserveCapacity(m_size);
-    clone->m_buffer.append(m_buffer.data(), m_buffer.size());
-    for (unsigned i = 0; i < m_segments.size(); ++i)
-        clone->m_buffer.append(m_segments[i], segmentSize);
+    const char* segment;
+    unsigned position = 0;
+    while (unsigned length = getSomeData(segment, position)) {
+        clone->m_buffer.append(segment, length);
+        position += length;
+    }
     return clone;
 }
 
@@ -216,14 +251,28 @@ const Vector<char>& SharedBuffer::buffer() const
         m_buffer.resize(m_size);
         char* destination = m_buffer.data() + bufferSize;
         unsigned bytesLeft = m_size - bufferSize;
+        unsigned segmentBytesLeft = sharedSegmentsOffset() - bufferSize;
         for (unsigned i = 0; i < m_segments.size(); ++i) {
-            unsigned bytesToCopy = min(bytesLeft, segmentSize);
+            unsigned bytesToCopy = min(segmentBytesLeft, segmentSize);
             memcpy(destination, m_segments[i], bytesToCopy);
             destination += bytesToCopy;
             bytesLeft -= bytesToCopy;
+            segmentBytesLeft -= bytesToCopy;
             freeSegment(m_segments[i]);
         }
         m_segments.clear();
+        for (unsigned i = 0; i < m_sharedSegments.size(); ++i) {
+            const char* segment;
+            unsigned position = 0;
+            while (unsigned length = m_sharedSegments[i]->getSomeData(segment, position)) {
+                memcpy(destination, segment, length);
+                destination += length;
+                bytesLeft -= length;
+                position += length;
+            }
+        }
+        m_sharedSegments.clear();
+        m_sharedSegmentPositions.clear();
 #if HAVE(NETWORK_CFDATA_ARRAY_CALLBACK)
         copyDataArrayAndClear(destination, bytesLeft);
 #endif
@@ -248,9 +297,16 @@ unsigned SharedBuffer::getSomeData(const char*& someData, unsigned position) con
         someData = m_buffer.data() + position;
         return consecutiveSize - position;
     }
+
+    unsigned segmentsEnd = sharedSegmentsOffset();
+    if (position >= segmentsEnd) {
+        const unsigned* positions = m_sharedSegmentPositions.data();
+        size_t index = upper_bound(positions, positions + m_sharedSegmentPositions.size(), position) - positions - 1;
+        return m_sharedSegments[index]->getSomeData(someData, position - positions[index]);
+    }
  
     position -= consecutiveSize;
-    unsigned segmentedSize = m_size - consecutiveSize;
+    unsigned segmentedSize = segmentsEnd - consecutiveSize;
     unsigned segments = m_segments.size();
     unsigned segment = segmentIndex(position);
     ASSERT(segment < segments);
@@ -260,6 +316,19 @@ unsigned SharedBuffer::getSomeData(const char*& someData, unsigned position) con
     return segment == segments - 1 ? segmentedSize - position : segmentSize - positionInSegment;
 }
 
+bool SharedBuffer::isContiguous() const
+{
+    if (hasPlatformData() || m_purgeableBuffer)
+        return true;
+
+    return m_buffer.size() == m_size;
+}
+
+unsigned SharedBuffer::sharedSegmentsOffset() const
+{
+    return m_sharedSegmentPositions.isEmpty() ? m_size : m_sharedSegmentPositions[0];
+}
+
 #if !USE(CF) || PLATFORM(QT)
 
 inline void SharedBuffer::clearPlatformData()
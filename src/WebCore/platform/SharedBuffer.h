@@ -30,6 +30,7 @@
 #include <wtf/Forward.h>
 #include <wtf/OwnPtr.h>
 #include <wtf/RefCounted.h>
+#include <wtf/RefPtr.h>
 #include <wtf/Vector.h>
 
 #if USE(CF)
@@ -88,6 +89,10 @@ public:
     void append(const char*, unsigned);
     void append(const Vector<char>&);
 
+    // Appends |segment| by reference instead of copying its bytes. |segment|
+    // must not be modified by anyone else afterwards.
+    void appendSegment(PassRefPtr<SharedBuffer> segment);
+
     void clear();
     const char* platformData() const;
     unsigned platformDataSize() const;
@@ -117,6 +122,10 @@ public:
     //      }
     unsigned getSomeData(const char*& data, unsigned position = 0) const;
 
+    // Return true when getSomeData(data, 0) covers the whole buffer, so data()
+    // will not have to merge segments.
+    bool isContiguous() const;
+
 private:
     SharedBuffer();
     SharedBuffer(const char*, int);
@@ -132,10 +141,15 @@ private:
     void clearPlatformData();
     void maybeTransferPlatformData();
     bool hasPlatformData() const;
+
+    unsigned sharedSegmentsOffset() const;
     
     unsigned m_size;
     mutable Vector<char> m_buffer;
     mutable Vector<char*> m_segments;
+    // Segments appended by reference always follow m_buffer and m_segments.
+    mutable Vector<RefPtr<SharedBuffer> > m_sharedSegments;
+    mutable Vector<unsigned> m_sharedSegmentPositions;
     OwnPtr<PurgeableBuffer> m_purgeableBuffer;
 #if HAVE(NETWORK_CFDATA_ARRAY_CALLBACK)
     mutable Vector<RetainPtr<CFDataRef> > m_dataArray;
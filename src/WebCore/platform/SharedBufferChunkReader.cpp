@@ -78,6 +78,17 @@ bool SharedBufferChunkReader::nextChunk(Vector<char>& chunk, bool includeSeparat
     chunk.clear();
     while (true) {
         while (m_segmentIndex < m_segmentLength) {
+            if (!m_separatorIndex) {
+                // Copy everything up to the next possible separator straight out of the segment.
+                const char* start = m_segment + m_segmentIndex;
+                size_t bytesLeft = m_segmentLength - m_segmentIndex;
+                const char* separatorStart = static_cast<const char*>(memchr(start, m_separator[0], bytesLeft));
+                size_t runLength = separatorStart ? separatorStart - start : bytesLeft;
+                chunk.append(start, runLength);
+                m_segmentIndex += runLength;
+                if (!separatorStart)
+                    break;
+            }
             char currentCharacter = m_segment[m_segmentIndex++];
             if (currentCharacter != m_separator[m_separatorIndex]) {
                 if (m_separatorIndex > 0) {
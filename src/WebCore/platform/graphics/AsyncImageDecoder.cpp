@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "AsyncImageDecoder.h"
+
+#include "SharedBuffer.h"
+#include <algorithm>
+#include <wtf/CurrentTime.h>
+#include <wtf/MainThread.h>
+#include <wtf/NumberOfCores.h>
+#include <wtf/OwnPtr.h>
+
+#if PLATFORM(QT)
+#include "ImageDecoderQt.h"
+#else
+#include "ImageDecoder.h"
+#endif
+
+namespace WebCore {
+
+static const int maximumDecodingThreads = 4;
+
+PassOwnPtr<ImageDecodingTask> ImageDecodingTask::create(ImageSource* source, SharedBuffer* data, const IntSize& desiredSize, ImageSource::AlphaOption alphaOption, ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption)
+{
+    return adoptPtr(new ImageDecodingTask(source, data, desiredSize, alphaOption, gammaAndColorProfileOption));
+}
+
+ImageDecodingTask::ImageDecodingTask(ImageSource* source, SharedBuffer* data, const IntSize& desiredSize, ImageSource::AlphaOption alphaOption, ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption)
+    : m_source(source)
+    , m_data(SharedBuffer::create(data->data(), data->size()))
+    , m_desiredSize(desiredSize)
+    , m_alphaOption(alphaOption)
+    , m_gammaAndColorProfileOption(gammaAndColorProfileOption)
+    , m_decoder(0)
+    , m_decodingTime(0)
+{
+    ASSERT(isMainThread());
+}
+
+ImageDecodingTask::~ImageDecodingTask()
+{
+    ASSERT(isMainThread());
+    delete m_decoder;
+}
+
+void ImageDecodingTask::decode()
+{
+    ASSERT(!isMainThread());
+
+    double startTime = monotonicallyIncreasingTime();
+    m_decoder = static_cast<NativeImageSourcePtr>(ImageDecoder::create(*m_data, m_alphaOption, m_gammaAndColorProfileOption));
+    if (m_decoder) {
+        m_decoder->setDesiredSize(m_desiredSize);
+#if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
+        if (ImageSource::maxPixelsPerDecodedImage())
+            m_decoder->setMaxNumPixels(ImageSource::maxPixelsPerDecodedImage());
+#endif
+        m_decoder->setData(m_data.get(), true);
+        m_decoder->frameBufferAtIndex(0);
+    }
+    m_decodingTime = monotonicallyIncreasingTime() - startTime;
+
+    // Decoding is finished, but the ImageSource may only be touched on the main thread.
+    callOnMainThread(notifyCompleteDispatch, this);
+}
+
+NativeImageSourcePtr ImageDecodingTask::releaseDecoder()
+{
+    NativeImageSourcePtr decoder = m_decoder;
+    m_decoder = 0;
+    return decoder;
+}
+
+void ImageDecodingTask::notifyCompleteDispatch(void* userData)
+{
+    ImageDecodingTask* task = reinterpret_cast<ImageDecodingTask*>(userData);
+    ASSERT(task);
+    if (!task)
+        return;
+
+    task->notifyComplete();
+}
+
+void ImageDecodingTask::notifyComplete()
+{
+    if (m_source)
+        m_source->didDecodeAsynchronously(this);
+
+    // Our ownership was given up in AsyncImageDecoder::runLoop().
+    delete this;
+}
+
+AsyncImageDecoder& AsyncImageDecoder::shared()
+{
+    ASSERT(isMainThread());
+    DEFINE_STATIC_LOCAL(AsyncImageDecoder, decoder, ());
+    return decoder;
+}
+
+AsyncImageDecoder::AsyncImageDecoder()
+{
+    // Leave a core to the main thread.
+    int threadCount = std::max(1, std::min(numberOfProcessorCores() - 1, maximumDecodingThreads));
+
+    MutexLocker lock(m_threadCreationMutex);
+    for (int i = 0; i < threadCount; ++i)
+        m_threads.append(createThread(AsyncImageDecoder::threadEntry, this, "Image Decoder"));
+}
+
+AsyncImageDecoder::~AsyncImageDecoder()
+{
+    m_queue.kill();
+
+    for (size_t i = 0; i < m_threads.size(); ++i) {
+        void* exitCode;
+        waitForThreadCompletion(m_threads[i], &exitCode);
+    }
+}
+
+void AsyncImageDecoder::decodeAsync(PassOwnPtr<ImageDecodingTask> task)
+{
+    ASSERT(isMainThread());
+    m_queue.append(task); // Ownership of the task is taken by the queue.
+}
+
+void* AsyncImageDecoder::threadEntry(void* threadData)
+{
+    ASSERT(threadData);
+    AsyncImageDecoder* decoder = reinterpret_cast<AsyncImageDecoder*>(threadData);
+    decoder->runLoop();
+    return 0;
+}
+
+void AsyncImageDecoder::runLoop()
+{
+    ASSERT(!isMainThread());
+
+    {
+        // Wait until all the threads have been created before starting the run loop.
+        MutexLocker lock(m_threadCreationMutex);
+    }
+
+    while (OwnPtr<ImageDecodingTask> task = m_queue.waitForMessage()) {
+        // The task deletes itself on the main thread, see ImageDecodingTask::notifyComplete().
+        task.leakPtr()->decode();
+    }
+}
+
+} // namespace WebCore
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef AsyncImageDecoder_h
+#define AsyncImageDecoder_h
+
+#include "ImageSource.h"
+#include <wtf/MessageQueue.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class SharedBuffer;
+
+// Decodes the first frame of a fully received image with a decoder of its own.
+// The task is created on the main thread, runs on a decoding thread and
+// reports back to its ImageSource on the main thread, where it is deleted.
+class ImageDecodingTask {
+    WTF_MAKE_NONCOPYABLE(ImageDecodingTask);
+public:
+    static PassOwnPtr<ImageDecodingTask> create(ImageSource*, SharedBuffer* data, const IntSize& desiredSize, ImageSource::AlphaOption, ImageSource::GammaAndColorProfileOption);
+    ~ImageDecodingTask();
+
+    // Main thread only. The decoding still runs, but its result is dropped.
+    void cancel() { m_source = 0; }
+
+    void decode();
+
+    // Hands the decoder, with its first frame decoded, over to the caller.
+    NativeImageSourcePtr releaseDecoder();
+    double decodingTime() const { return m_decodingTime; }
+
+private:
+    ImageDecodingTask(ImageSource*, SharedBuffer* data, const IntSize& desiredSize, ImageSource::AlphaOption, ImageSource::GammaAndColorProfileOption);
+
+    static void notifyCompleteDispatch(void* userData);
+    void notifyComplete();
+
+    ImageSource* m_source;
+    RefPtr<SharedBuffer> m_data; // A private copy; SharedBuffer is not thread safe.
+    IntSize m_desiredSize;
+    ImageSource::AlphaOption m_alphaOption;
+    ImageSource::GammaAndColorProfileOption m_gammaAndColorProfileOption;
+    NativeImageSourcePtr m_decoder;
+    double m_decodingTime;
+};
+
+// A small pool of threads shared by every ImageSource that decodes
+// asynchronously.
+class AsyncImageDecoder {
+    WTF_MAKE_NONCOPYABLE(AsyncImageDecoder);
+public:
+    static AsyncImageDecoder& shared();
+
+    // Must be called on the main thread.
+    void decodeAsync(PassOwnPtr<ImageDecodingTask>);
+
+private:
+    AsyncImageDecoder();
+    ~AsyncImageDecoder();
+
+    static void* threadEntry(void* threadData);
+    void runLoop();
+
+    Vector<ThreadIdentifier> m_threads;
+    Mutex m_threadCreationMutex;
+    MessageQueue<ImageDecodingTask> m_queue;
+};
+
+} // namespace WebCore
+
+#endif // AsyncImageDecoder_h
@@ -65,6 +65,7 @@ BitmapImage::BitmapImage(ImageObserver* observer)
     , m_frameCount(0)
 {
     initPlatformData();
+    m_source.setAsyncDecodingClient(this);
 }
 
 BitmapImage::~BitmapImage()
@@ -75,17 +76,16 @@ BitmapImage::~BitmapImage()
 
 void BitmapImage::destroyDecodedData(bool destroyAll)
 {
-    int framesCleared = 0;
+    unsigned frameBytesCleared = 0;
     const size_t clearBeforeFrame = destroyAll ? m_frames.size() : m_currentFrame;
     for (size_t i = 0; i < clearBeforeFrame; ++i) {
         // The underlying frame isn't actually changing (we're just trying to
         // save the memory for the framebuffer data), so we don't need to clear
         // the metadata.
-        if (m_frames[i].clear(false))
-          ++framesCleared;
+        frameBytesCleared += clearFrame(i, false);
     }
 
-    destroyMetadataAndNotify(framesCleared);
+    destroyMetadataAndNotify(frameBytesCleared);
 
     m_source.clear(destroyAll, clearBeforeFrame, data(), m_allDataReceived);
     return;
@@ -96,19 +96,29 @@ void BitmapImage::destroyDecodedDataIfNecessary(bool destroyAll)
     // Animated images >5MB are considered large enough that we'll only hang on
     // to one frame at a time.
     static const unsigned cLargeAnimationCutoff = 5242880;
-    if (m_frames.size() * frameBytes(m_size) > cLargeAnimationCutoff)
+    if (m_frames.size() * frameBytes(m_source.decodedFrameSizeAtIndex(m_currentFrame)) > cLargeAnimationCutoff)
         destroyDecodedData(destroyAll);
 }
 
-void BitmapImage::destroyMetadataAndNotify(int framesCleared)
+unsigned BitmapImage::clearFrame(size_t index, bool clearMetadata)
+{
+    if (index >= m_frames.size() || !m_frames[index].clear(clearMetadata))
+        return 0;
+
+    unsigned frameBytesCleared = m_frames[index].m_frameBytes;
+    m_frames[index].m_frameBytes = 0;
+    return frameBytesCleared;
+}
+
+void BitmapImage::destroyMetadataAndNotify(unsigned frameBytesCleared)
 {
     m_isSolidColor = false;
     m_checkedForSolidColor = false;
     invalidatePlatformData();
 
-    int deltaBytes = framesCleared * -frameBytes(m_size);
+    int deltaBytes = -static_cast<int>(frameBytesCleared);
     m_decodedSize += deltaBytes;
-    if (framesCleared > 0) {
+    if (frameBytesCleared > 0) {
         deltaBytes -= m_decodedPropertiesSize;
         m_decodedPropertiesSize = 0;
     }
@@ -138,7 +148,8 @@ void BitmapImage::cacheFrame(size_t index)
     if (frameSize != m_size)
         m_hasUniformFrameSize = false;
     if (m_frames[index].m_frame) {
-        int deltaBytes = frameBytes(frameSize);
+        int deltaBytes = frameBytes(m_source.decodedFrameSizeAtIndex(index));
+        m_frames[index].m_frameBytes = deltaBytes;
         m_decodedSize += deltaBytes;
         // The fully-decoded frame will subsume the partially decoded data used
         // to determine image properties.
@@ -149,6 +160,18 @@ void BitmapImage::cacheFrame(size_t index)
     }
 }
 
+void BitmapImage::frameDecodedAsynchronously(size_t index)
+{
+    // Forget what was cached while the frame was still being decoded, then
+    // cache the real frame right away so that its memory is accounted for
+    // even if the image is not on screen any more.
+    destroyMetadataAndNotify(clearFrame(index, true));
+    cacheFrame(index);
+
+    if (imageObserver())
+        imageObserver()->changedInRect(this, IntRect(IntPoint(), size()));
+}
+
 void BitmapImage::didDecodeProperties() const
 {
     if (m_decodedSize)
@@ -186,6 +209,52 @@ IntSize BitmapImage::currentFrameSize() const
     return frameSize;
 }
 
+void BitmapImage::setDisplayedSize(const IntSize& displayedSize)
+{
+    if (displayedSize.isEmpty() || !isSizeAvailable())
+        return;
+
+    // Renderers sharing the image each report their size; decode for the
+    // largest.
+    IntSize desiredSize = displayedSize.shrunkTo(size());
+    if (!m_desiredDecodedSize.isEmpty())
+        desiredSize = desiredSize.expandedTo(m_desiredDecodedSize);
+    setDesiredDecodedSize(desiredSize);
+}
+
+void BitmapImage::requireDecodedSize(const IntSize& requiredSize)
+{
+    if (m_desiredDecodedSize.isEmpty())
+        return;
+    setDesiredDecodedSize(m_desiredDecodedSize.expandedTo(requiredSize.shrunkTo(size())));
+}
+
+void BitmapImage::setDesiredDecodedSize(const IntSize& desiredSize)
+{
+    if (desiredSize == m_desiredDecodedSize)
+        return;
+    m_desiredDecodedSize = desiredSize;
+    m_source.setDesiredSize(desiredSize);
+
+    if (!m_decodedSize) {
+        // Nothing is decoded yet; start over with a decoder that knows the size.
+        destroyDecodedData(true);
+        return;
+    }
+
+    // Frames are shrunk by powers of two, so larger ones often still do.
+    IntSize decodedFrameSize = m_source.decodedFrameSizeAtIndex(m_currentFrame);
+    if (decodedFrameSize.width() >= desiredSize.width() && decodedFrameSize.height() >= desiredSize.height())
+        return;
+
+    destroyDecodedData(true);
+
+    // The image is already on screen. Decode it again right away rather than
+    // leave a hole while a decoding thread works on it.
+    ImageSource::PlaceholderScope noPlaceholderScope(false);
+    frameAtIndex(m_currentFrame);
+}
+
 bool BitmapImage::getHotSpot(IntPoint& hotSpot) const
 {
     bool result = m_source.getHotSpot(hotSpot);
@@ -197,7 +266,7 @@ bool BitmapImage::dataChanged(bool allDataReceived)
 {
     // Because we're modifying the current frame, clear its (now possibly
     // inaccurate) metadata as well.
-    destroyMetadataAndNotify((!m_frames.isEmpty() && m_frames[m_frames.size() - 1].clear(true)) ? 1 : 0);
+    destroyMetadataAndNotify(m_frames.isEmpty() ? 0 : clearFrame(m_frames.size() - 1, true));
     
     // Feed all the data we've seen so far to the image decoder.
     m_allDataReceived = allDataReceived;
@@ -73,6 +73,7 @@ public:
         , m_isComplete(false)
         , m_duration(0)
         , m_hasAlpha(true) 
+        , m_frameBytes(0)
     {
     }
 
@@ -90,13 +91,14 @@ public:
     bool m_isComplete;
     float m_duration;
     bool m_hasAlpha;
+    unsigned m_frameBytes; // Less than the image size suggests when the frame was shrunk while decoding.
 };
 
 // =================================================
 // BitmapImage Class
 // =================================================
 
-class BitmapImage : public Image {
+class BitmapImage : public Image, public AsyncImageDecodingClient {
     friend class GeneratedImage;
     friend class GraphicsContext;
 public:
@@ -118,6 +120,8 @@ public:
     IntSize currentFrameSize() const;
     virtual bool getHotSpot(IntPoint&) const;
 
+    virtual void setDisplayedSize(const IntSize&);
+
     virtual bool dataChanged(bool allDataReceived);
     virtual String filenameExtension() const; 
 
@@ -153,7 +157,12 @@ public:
     virtual GdkPixbuf* getGdkPixbuf();
 #endif
 
-    virtual NativeImagePtr nativeImageForCurrentFrame() { return frameAtIndex(currentFrame()); }
+    virtual NativeImagePtr nativeImageForCurrentFrame()
+    {
+        // Callers expect the frame to be as large as the image.
+        requireDecodedSize(size());
+        return frameAtIndex(currentFrame());
+    }
     bool frameHasAlphaAtIndex(size_t);
     virtual bool currentFrameHasAlpha() { return frameHasAlphaAtIndex(currentFrame()); }
 
@@ -193,6 +202,15 @@ protected:
     // Decodes and caches a frame. Never accessed except internally.
     void cacheFrame(size_t index);
 
+    // Makes sure the frames are decoded at least |size| large, decoding them
+    // again if needed. Does nothing unless a renderer has reported the size
+    // it shows the image at; until then frames are decoded at full size.
+    void requireDecodedSize(const IntSize&);
+    void setDesiredDecodedSize(const IntSize&);
+
+    // AsyncImageDecodingClient
+    virtual void frameDecodedAsynchronously(size_t index);
+
     // Called to invalidate cached data.  When |destroyAll| is true, we wipe out
     // the entire frame buffer cache and tell the image source to destroy
     // everything; this is used when e.g. we want to free some room in the image
@@ -205,10 +223,14 @@ protected:
     // |destroyAll| along.
     void destroyDecodedDataIfNecessary(bool destroyAll);
 
+    // Clears the cached data of frame |index| (and optionally its metadata),
+    // returning the number of bytes freed.
+    unsigned clearFrame(size_t index, bool clearMetadata);
+
     // Generally called by destroyDecodedData(), destroys whole-image metadata
     // and notifies observers that the memory footprint has (hopefully)
-    // decreased by |framesCleared| times the size (in bytes) of a frame.
-    void destroyMetadataAndNotify(int framesCleared);
+    // decreased by |frameBytesCleared| bytes of frame data.
+    void destroyMetadataAndNotify(unsigned frameBytesCleared);
 
     // Whether or not size is available yet.    
     bool isSizeAvailable();
@@ -257,6 +279,7 @@ protected:
     
     ImageSource m_source;
     mutable IntSize m_size; // The size to use for the overall image (will just be the size of the first image).
+    IntSize m_desiredDecodedSize; // The largest size the image is shown at. Empty until a renderer reports one.
     
     size_t m_currentFrame; // The index of the current frame of animation.
     Vector<FrameData> m_frames; // An array of the cached frames of the animation. We have to ref frames to pin them in the cache.
@@ -177,15 +177,50 @@ void Font::drawEmphasisMarks(GraphicsContext* context, const TextRun& run, const
 
 float Font::width(const TextRun& run, HashSet<const SimpleFontData*>* fallbackFonts, GlyphOverflow* glyphOverflow) const
 {
+    // If the complex text implementation cannot return fallback fonts, avoid
+    // returning them for simple text as well.
+    static bool returnFallbackFonts = canReturnFallbackFontsForComplexText();
+
     CodePath codePathToUse = codePath(run);
     if (codePathToUse != Complex) {
-        // If the complex text implementation cannot return fallback fonts, avoid
-        // returning them for simple text as well.
-        static bool returnFallbackFonts = canReturnFallbackFontsForComplexText();
-        return floatWidthForSimpleText(run, 0, returnFallbackFonts ? fallbackFonts : 0, codePathToUse == SimpleWithGlyphOverflow || (glyphOverflow && glyphOverflow->computeBounds) ? glyphOverflow : 0);
+        if (!returnFallbackFonts)
+            fallbackFonts = 0;
+        if (codePathToUse != SimpleWithGlyphOverflow && !(glyphOverflow && glyphOverflow->computeBounds))
+            glyphOverflow = 0;
+    }
+
+    // Glyph overflow is not cached, and runs are measured again while web
+    // fonts load.
+    float* cachedWidth = 0;
+    if (!glyphOverflow && !loadingCustomFonts()) {
+        unsigned flags = codePathToUse | typesettingFeatures() << 2 | isSmallCaps() << 4;
+        cachedWidth = m_fontList->widthCache().add(run, flags, m_letterSpacing, m_wordSpacing);
+        if (cachedWidth && !isnan(*cachedWidth))
+            return *cachedWidth;
     }
 
-    return floatWidthForComplexText(run, fallbackFonts, glyphOverflow);
+    // Widths are only cached for runs that need no fallback fonts, so that a
+    // cache hit has none to report.
+    HashSet<const SimpleFontData*> runFallbackFonts;
+    bool tracksFallbackFonts = cachedWidth && (codePathToUse == Complex || returnFallbackFonts);
+    HashSet<const SimpleFontData*>* fallbackFontsForRun = tracksFallbackFonts ? &runFallbackFonts : fallbackFonts;
+
+    float width;
+    if (codePathToUse != Complex)
+        width = floatWidthForSimpleText(run, 0, fallbackFontsForRun, glyphOverflow);
+    else
+        width = floatWidthForComplexText(run, fallbackFontsForRun, glyphOverflow);
+
+    if (!runFallbackFonts.isEmpty()) {
+        if (fallbackFonts) {
+            HashSet<const SimpleFontData*>::const_iterator end = runFallbackFonts.end();
+            for (HashSet<const SimpleFontData*>::const_iterator it = runFallbackFonts.begin(); it != end; ++it)
+                fallbackFonts->add(*it);
+        }
+    } else if (cachedWidth)
+        *cachedWidth = width;
+
+    return width;
 }
 
 float Font::width(const TextRun& run, int& charsConsumed, String& glyphName) const
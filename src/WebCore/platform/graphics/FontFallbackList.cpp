@@ -53,6 +53,7 @@ void FontFallbackList::invalidate(PassRefPtr<FontSelector> fontSelector)
     m_pageZero = 0;
     m_pages.clear();
     m_cachedPrimarySimpleFontData = 0;
+    m_widthCache.clear();
     m_familyIndex = 0;    
     m_pitch = UnknownPitch;
     m_loadingCustomFonts = false;
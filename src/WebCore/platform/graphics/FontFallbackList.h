@@ -23,6 +23,7 @@
 
 #include "FontSelector.h"
 #include "SimpleFontData.h"
+#include "WidthCache.h"
 #include <wtf/Forward.h>
 #include <wtf/MainThread.h>
 
@@ -53,6 +54,8 @@ public:
     FontSelector* fontSelector() const { return m_fontSelector.get(); }
     unsigned generation() const { return m_generation; }
 
+    WidthCache& widthCache() const { return m_widthCache; }
+
     struct GlyphPagesHashTraits : HashTraits<int> {
         static const int minimumTableSize = 16;
     };
@@ -87,6 +90,7 @@ private:
     mutable GlyphPageTreeNode* m_pageZero;
     mutable const SimpleFontData* m_cachedPrimarySimpleFontData;
     RefPtr<FontSelector> m_fontSelector;
+    mutable WidthCache m_widthCache;
     mutable int m_familyIndex;
     unsigned short m_generation;
     mutable unsigned m_pitch : 3; // Pitch
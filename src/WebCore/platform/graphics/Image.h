@@ -100,6 +100,9 @@ public:
     bool isNull() const { return size().isEmpty(); }
 
     virtual void setContainerSize(const IntSize&) { }
+    // Tells the image the size a renderer shows it at, so that it need not be
+    // decoded any larger.
+    virtual void setDisplayedSize(const IntSize&) { }
     virtual bool usesContainerSize() const { return false; }
     virtual bool hasRelativeWidth() const { return false; }
     virtual bool hasRelativeHeight() const { return false; }
@@ -29,6 +29,11 @@
 #include "config.h"
 #include "ImageSource.h"
 
+#include "AsyncImageDecoder.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/MainThread.h>
+#include <wtf/OwnPtr.h>
+
 #if PLATFORM(QT)
 #include "ImageDecoderQt.h"
 #else
@@ -41,10 +46,21 @@ namespace WebCore {
 unsigned ImageSource::s_maxPixelsPerDecodedImage = 1024 * 1024;
 #endif
 
+bool ImageSource::s_decodesAsynchronously = false;
+// Smaller images decode in about a millisecond, less than the round trip costs in repaints.
+unsigned ImageSource::s_minPixelsForAsyncDecoding = 256 * 256;
+unsigned ImageSource::s_placeholderScopeDepth = 0;
+double ImageSource::s_mainThreadDecodingTime = 0;
+double ImageSource::s_decodingThreadTime = 0;
+
 ImageSource::ImageSource(ImageSource::AlphaOption alphaOption, ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption)
     : m_decoder(0)
     , m_alphaOption(alphaOption)
     , m_gammaAndColorProfileOption(gammaAndColorProfileOption)
+    , m_allDataReceived(false)
+    , m_asyncDecodingClient(0)
+    , m_asyncDecodingTask(0)
+    , m_asyncDecodingState(AsyncDecodingNotStarted)
 {
 }
 
@@ -61,10 +77,17 @@ void ImageSource::clear(bool destroyAll, size_t clearBeforeFrame, SharedBuffer*
         return;
     }
 
+    cancelAsyncDecoding();
+    m_asyncDecodingState = AsyncDecodingNotStarted;
+
     delete m_decoder;
     m_decoder = 0;
+    m_data = 0;
+    m_allDataReceived = false;
+    // Decoding starts again when the frame is next asked for, not now: the
+    // caller is usually trying to free memory.
     if (data)
-        setData(data, allDataReceived);
+        setDecoderData(data, allDataReceived);
 }
 
 bool ImageSource::initialized() const
@@ -73,6 +96,17 @@ bool ImageSource::initialized() const
 }
 
 void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
+{
+    setDecoderData(data, allDataReceived);
+
+    if (allDataReceived && m_asyncDecodingState != AsyncDecodingFinished && canDecodeAsynchronously()) {
+        // A task still running has a copy of older data.
+        cancelAsyncDecoding();
+        startAsyncDecoding();
+    }
+}
+
+void ImageSource::setDecoderData(SharedBuffer* data, bool allDataReceived)
 {
     // Make the decoder by sniffing the bytes.
     // This method will examine the data and instantiate an instance of the appropriate decoder plugin.
@@ -80,12 +114,16 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
     // made.
     if (!m_decoder) {
         m_decoder = static_cast<NativeImageSourcePtr>(ImageDecoder::create(*data, m_alphaOption, m_gammaAndColorProfileOption));
+        if (m_decoder)
+            m_decoder->setDesiredSize(m_desiredSize);
 #if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
         if (m_decoder && s_maxPixelsPerDecodedImage)
             m_decoder->setMaxNumPixels(s_maxPixelsPerDecodedImage);
 #endif
     }
 
+    m_data = data;
+    m_allDataReceived = allDataReceived;
     if (m_decoder)
         m_decoder->setData(data, allDataReceived);
 }
@@ -110,6 +148,11 @@ IntSize ImageSource::frameSizeAtIndex(size_t index) const
     return m_decoder ? m_decoder->frameSizeAtIndex(index) : IntSize();
 }
 
+IntSize ImageSource::decodedFrameSizeAtIndex(size_t index) const
+{
+    return m_decoder ? m_decoder->decodedFrameSizeAtIndex(index) : IntSize();
+}
+
 bool ImageSource::getHotSpot(IntPoint&) const
 {
     return false;
@@ -132,10 +175,10 @@ size_t ImageSource::frameCount() const
 
 NativeImagePtr ImageSource::createFrameAtIndex(size_t index)
 {
-    if (!m_decoder)
+    if (!m_decoder || isDecodingAsynchronously(index))
         return 0;
 
-    ImageFrame* buffer = m_decoder->frameBufferAtIndex(index);
+    ImageFrame* buffer = frameBufferAtIndex(index);
     if (!buffer || buffer->status() == ImageFrame::FrameEmpty)
         return 0;
 
@@ -151,10 +194,10 @@ NativeImagePtr ImageSource::createFrameAtIndex(size_t index)
 
 float ImageSource::frameDurationAtIndex(size_t index)
 {
-    if (!m_decoder)
+    if (!m_decoder || isDecodingAsynchronously(index))
         return 0;
 
-    ImageFrame* buffer = m_decoder->frameBufferAtIndex(index);
+    ImageFrame* buffer = frameBufferAtIndex(index);
     if (!buffer || buffer->status() == ImageFrame::FrameEmpty)
         return 0;
 
@@ -177,16 +220,98 @@ bool ImageSource::frameHasAlphaAtIndex(size_t index)
     // TODO: Perhaps we should ensure that each individual decoder returns true
     // in this case.
     return !frameIsCompleteAtIndex(index)
-        || m_decoder->frameBufferAtIndex(index)->hasAlpha();
+        || frameBufferAtIndex(index)->hasAlpha();
 }
 
 bool ImageSource::frameIsCompleteAtIndex(size_t index)
 {
-    if (!m_decoder)
+    if (!m_decoder || isDecodingAsynchronously(index))
         return false;
 
-    ImageFrame* buffer = m_decoder->frameBufferAtIndex(index);
+    ImageFrame* buffer = frameBufferAtIndex(index);
     return buffer && buffer->status() == ImageFrame::FrameComplete;
 }
 
+ImageFrame* ImageSource::frameBufferAtIndex(size_t index)
+{
+    // Once the first frame is being decoded here, for example progressively
+    // while the data arrives, it keeps being decoded here.
+    if (!index)
+        m_asyncDecodingState = AsyncDecodingFinished;
+
+    double startTime = monotonicallyIncreasingTime();
+    ImageFrame* buffer = m_decoder->frameBufferAtIndex(index);
+    s_mainThreadDecodingTime += monotonicallyIncreasingTime() - startTime;
+    return buffer;
+}
+
+bool ImageSource::canDecodeAsynchronously()
+{
+    if (!s_decodesAsynchronously || !m_asyncDecodingClient || !m_allDataReceived || !m_decoder)
+        return false;
+
+    // Animated images keep decoding frame by frame on the main thread.
+    if (!m_decoder->isSizeAvailable() || m_decoder->frameCount() != 1)
+        return false;
+
+    IntSize imageSize = m_decoder->size();
+    return static_cast<unsigned long long>(imageSize.width()) * imageSize.height() >= s_minPixelsForAsyncDecoding;
+}
+
+void ImageSource::startAsyncDecoding()
+{
+    ASSERT(isMainThread());
+    ASSERT(!m_asyncDecodingTask);
+
+    OwnPtr<ImageDecodingTask> task = ImageDecodingTask::create(this, m_data.get(), m_desiredSize, m_alphaOption, m_gammaAndColorProfileOption);
+    m_asyncDecodingTask = task.get();
+    m_asyncDecodingState = AsyncDecodingPending;
+    AsyncImageDecoder::shared().decodeAsync(task.release());
+}
+
+void ImageSource::cancelAsyncDecoding()
+{
+    if (!m_asyncDecodingTask)
+        return;
+
+    m_asyncDecodingTask->cancel();
+    m_asyncDecodingTask = 0;
+    m_asyncDecodingState = AsyncDecodingNotStarted;
+}
+
+bool ImageSource::isDecodingAsynchronously(size_t index)
+{
+    if (index || m_asyncDecodingState == AsyncDecodingFinished || !canDecodeAsynchronously())
+        return false;
+
+    if (!PlaceholderScope::isActive()) {
+        // Someone needs the pixels right now; decode them here instead.
+        cancelAsyncDecoding();
+        m_asyncDecodingState = AsyncDecodingFinished;
+        return false;
+    }
+
+    if (m_asyncDecodingState == AsyncDecodingNotStarted)
+        startAsyncDecoding();
+    return true;
+}
+
+void ImageSource::didDecodeAsynchronously(ImageDecodingTask* task)
+{
+    ASSERT(task == m_asyncDecodingTask);
+    m_asyncDecodingTask = 0;
+    m_asyncDecodingState = AsyncDecodingFinished;
+    s_decodingThreadTime += task->decodingTime();
+
+    // The new decoder saw the same, complete data and already holds the frame.
+    // The old one never decoded it, so nothing references its frame buffers.
+    if (NativeImageSourcePtr decoder = task->releaseDecoder()) {
+        delete m_decoder;
+        m_decoder = decoder;
+    }
+
+    if (m_asyncDecodingClient)
+        m_asyncDecodingClient->frameDecodedAsynchronously(0);
+}
+
 }
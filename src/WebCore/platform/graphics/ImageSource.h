@@ -27,8 +27,10 @@
 #ifndef ImageSource_h
 #define ImageSource_h
 
+#include "IntSize.h"
 #include <wtf/Forward.h>
 #include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
 #include <wtf/Vector.h>
 
 #if PLATFORM(WX)
@@ -56,8 +58,9 @@ class NativeImageSkia;
 
 namespace WebCore {
 
+class ImageDecodingTask;
+class ImageFrame;
 class IntPoint;
-class IntSize;
 class SharedBuffer;
 
 #if USE(CG)
@@ -113,6 +116,15 @@ const int cAnimationLoopOnce = 0;
 const int cAnimationLoopInfinite = -1;
 const int cAnimationNone = -2;
 
+// Told when the first frame of an image has been decoded on a decoding thread.
+class AsyncImageDecodingClient {
+public:
+    virtual void frameDecodedAsynchronously(size_t) = 0;
+
+protected:
+    virtual ~AsyncImageDecodingClient() { }
+};
+
 class ImageSource {
     WTF_MAKE_NONCOPYABLE(ImageSource);
 public:
@@ -126,9 +138,54 @@ public:
         GammaAndColorProfileIgnored
     };
 
+    // While a PlaceholderScope is alive, a frame that is still being decoded
+    // on a decoding thread reads as not decoded yet. FrameView uses one while
+    // painting the page; everyone else (canvas, printing, drag images) gets
+    // the frame decoded synchronously. A scope that does not allow
+    // placeholders turns them off until it goes away, even inside another.
+    class PlaceholderScope {
+        WTF_MAKE_NONCOPYABLE(PlaceholderScope);
+    public:
+        PlaceholderScope(bool allowPlaceholders = true)
+            : m_savedDepth(s_placeholderScopeDepth)
+        {
+            s_placeholderScopeDepth = allowPlaceholders ? m_savedDepth + 1 : 0;
+        }
+        ~PlaceholderScope()
+        {
+            s_placeholderScopeDepth = m_savedDepth;
+        }
+
+        static bool isActive() { return s_placeholderScopeDepth; }
+
+    private:
+        unsigned m_savedDepth;
+    };
+
     ImageSource(AlphaOption alphaOption = AlphaPremultiplied, GammaAndColorProfileOption gammaAndColorProfileOption = GammaAndColorProfileApplied);
     ~ImageSource();
 
+    // Large single-frame images start decoding on a decoding thread once all
+    // of their data has arrived. Off by default; only sources with a client
+    // take part.
+    static bool decodesAsynchronously() { return s_decodesAsynchronously; }
+    static void setDecodesAsynchronously(bool flag) { s_decodesAsynchronously = flag; }
+    static unsigned minPixelsForAsyncDecoding() { return s_minPixelsForAsyncDecoding; }
+    static void setMinPixelsForAsyncDecoding(unsigned pixels) { s_minPixelsForAsyncDecoding = pixels; }
+
+    // Seconds spent producing frames in image decoders, on the main thread and
+    // on the decoding threads.
+    static double mainThreadDecodingTime() { return s_mainThreadDecodingTime; }
+    static double decodingThreadTime() { return s_decodingThreadTime; }
+
+    void setAsyncDecodingClient(AsyncImageDecodingClient* client) { m_asyncDecodingClient = client; }
+
+    // Decoders that can (JPEG, PNG and GIF) shrink the image while decoding
+    // it, as long as it stays at least |size| large. An empty size decodes at
+    // full size. Takes effect for decoders made from then on, that is after
+    // clear(true).
+    void setDesiredSize(const IntSize& size) { m_desiredSize = size; }
+
     // Tells the ImageSource that the Image no longer cares about decoded frame
     // data -- at all (if |destroyAll| is true), or before frame
     // |clearBeforeFrame| (if |destroyAll| is false).  The ImageSource should
@@ -163,6 +220,8 @@ public:
     bool isSizeAvailable();
     IntSize size() const;
     IntSize frameSizeAtIndex(size_t) const;
+    // Smaller than frameSizeAtIndex() when the frame is shrunk while decoding.
+    IntSize decodedFrameSizeAtIndex(size_t) const;
     bool getHotSpot(IntPoint&) const;
 
     size_t bytesDecodedToDetermineProperties() const;
@@ -179,15 +238,47 @@ public:
     bool frameHasAlphaAtIndex(size_t); // Whether or not the frame actually used any alpha.
     bool frameIsCompleteAtIndex(size_t); // Whether or not the frame is completely decoded.
 
+    // Called by ImageDecodingTask on the main thread.
+    void didDecodeAsynchronously(ImageDecodingTask*);
+
 #if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
     static unsigned maxPixelsPerDecodedImage() { return s_maxPixelsPerDecodedImage; }
     static void setMaxPixelsPerDecodedImage(unsigned maxPixels) { s_maxPixelsPerDecodedImage = maxPixels; }
 #endif
 
 private:
+    enum AsyncDecodingState {
+        AsyncDecodingNotStarted,
+        AsyncDecodingPending,
+        AsyncDecodingFinished // The decoder has the frame, or will decode it synchronously.
+    };
+
+    void setDecoderData(SharedBuffer*, bool allDataReceived);
+    ImageFrame* frameBufferAtIndex(size_t);
+
+    bool canDecodeAsynchronously();
+    void startAsyncDecoding();
+    void cancelAsyncDecoding();
+    // Whether the frame should be reported as not decoded yet because a
+    // decoding thread is working on it. May start that work.
+    bool isDecodingAsynchronously(size_t);
+
     NativeImageSourcePtr m_decoder;
     AlphaOption m_alphaOption;
     GammaAndColorProfileOption m_gammaAndColorProfileOption;
+
+    RefPtr<SharedBuffer> m_data;
+    bool m_allDataReceived;
+    IntSize m_desiredSize;
+    AsyncImageDecodingClient* m_asyncDecodingClient;
+    ImageDecodingTask* m_asyncDecodingTask; // Owned by the decoding threads until it reports back.
+    AsyncDecodingState m_asyncDecodingState;
+
+    static bool s_decodesAsynchronously;
+    static unsigned s_minPixelsForAsyncDecoding;
+    static unsigned s_placeholderScopeDepth;
+    static double s_mainThreadDecodingTime;
+    static double s_decodingThreadTime;
 #if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
     static unsigned s_maxPixelsPerDecodedImage;
 #endif
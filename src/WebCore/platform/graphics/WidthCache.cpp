@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "WidthCache.h"
+
+#include <limits>
+#include <wtf/MathExtras.h>
+
+namespace WebCore {
+
+unsigned WidthCache::s_hitCount = 0;
+unsigned WidthCache::s_missCount = 0;
+
+float* WidthCache::add(const TextRun& run, unsigned flags, short letterSpacing, short wordSpacing)
+{
+    unsigned length = run.length();
+    if (!length || length > Key::capacity)
+        return 0;
+
+    // Justified and SVG text is rare enough not to bother.
+    if (run.expansion() || run.renderingContext())
+        return 0;
+#if ENABLE(SVG)
+    if (run.horizontalGlyphStretch() != 1)
+        return 0;
+#endif
+
+    // A tab is as wide as it takes to reach the next tab stop, which depends
+    // on where the run starts.
+    if (run.allowTabs()) {
+        for (unsigned i = 0; i < length; ++i) {
+            if (run[i] == '\t')
+                return 0;
+        }
+    }
+
+    unsigned runFlags = run.rtl()
+        | run.directionalOverride() << 1
+        | run.applyRunRounding() << 2
+        | run.applyWordRounding() << 3
+        | run.spacingDisabled() << 4;
+
+    Key key(run.characters(), length, flags << 5 | runFlags, letterSpacing, wordSpacing);
+    pair<Map::iterator, bool> result = m_map.add(key, std::numeric_limits<float>::quiet_NaN());
+    float* width = &result.first->second;
+    if (!isnan(*width)) {
+        ++s_hitCount;
+        return width;
+    }
+
+    ++s_missCount;
+    if (!result.second || m_map.size() <= maxSize)
+        return width;
+
+    // No need to be clever, this only keeps long pages of distinct words from
+    // growing the cache without bound.
+    m_map.clear();
+    return 0;
+}
+
+} // namespace WebCore
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WidthCache_h
+#define WidthCache_h
+
+#include "TextRun.h"
+#include <string.h>
+#include <wtf/HashFunctions.h>
+#include <wtf/HashMap.h>
+#include <wtf/HashTraits.h>
+#include <wtf/StringHasher.h>
+
+namespace WebCore {
+
+// Remembers the widths of short runs of text, mostly words, which line layout
+// measures over and over again. A Font keeps one in its FontFallbackList, so
+// that copies of the Font share it and it goes away with the font data.
+class WidthCache {
+    WTF_MAKE_NONCOPYABLE(WidthCache);
+public:
+    WidthCache() { }
+
+    // Returns where to find or store the width of |run|, holding NaN when the
+    // width is not known yet, or 0 if the run cannot be cached. |flags| and
+    // the spacings stand for the state of the Font that the width depends on;
+    // the settings of the run itself are looked at here. The pointer is good
+    // until the next call.
+    float* add(const TextRun&, unsigned flags, short letterSpacing, short wordSpacing);
+    void clear() { m_map.clear(); }
+
+    // Counts over all caches since startup.
+    static unsigned hitCount() { return s_hitCount; }
+    static unsigned missCount() { return s_missCount; }
+
+private:
+    class Key {
+    public:
+        static const unsigned capacity = 16;
+
+        Key()
+            : m_hash(0)
+            , m_flags(0)
+            , m_letterSpacing(0)
+            , m_wordSpacing(0)
+            , m_length(0)
+        {
+        }
+
+        Key(WTF::HashTableDeletedValueType)
+            : m_hash(0)
+            , m_flags(0)
+            , m_letterSpacing(0)
+            , m_wordSpacing(0)
+            , m_length(deletedValueLength)
+        {
+        }
+
+        Key(const UChar* characters, unsigned length, unsigned flags, short letterSpacing, short wordSpacing)
+            : m_flags(flags)
+            , m_letterSpacing(letterSpacing)
+            , m_wordSpacing(wordSpacing)
+            , m_length(length)
+        {
+            ASSERT(length && length <= capacity);
+            memcpy(m_characters, characters, length * sizeof(UChar));
+            unsigned spacing = static_cast<unsigned>(static_cast<uint16_t>(letterSpacing)) << 16 | static_cast<uint16_t>(wordSpacing);
+            m_hash = WTF::intHash(static_cast<uint64_t>(StringHasher::computeHash(characters, length)) << 32 | (flags ^ spacing));
+        }
+
+        bool isHashTableDeletedValue() const { return m_length == deletedValueLength; }
+        unsigned hash() const { return m_hash; }
+
+        bool operator==(const Key& other) const
+        {
+            return m_hash == other.m_hash && m_length == other.m_length && m_flags == other.m_flags
+                && m_letterSpacing == other.m_letterSpacing && m_wordSpacing == other.m_wordSpacing
+                && (m_length == deletedValueLength || !memcmp(m_characters, other.m_characters, m_length * sizeof(UChar)));
+        }
+
+    private:
+        static const unsigned short deletedValueLength = capacity + 1;
+
+        unsigned m_hash;
+        unsigned m_flags;
+        short m_letterSpacing;
+        short m_wordSpacing;
+        unsigned short m_length;
+        UChar m_characters[capacity];
+    };
+
+    struct KeyHash {
+        static unsigned hash(const Key& key) { return key.hash(); }
+        static bool equal(const Key& a, const Key& b) { return a == b; }
+        static const bool safeToCompareToEmptyOrDeleted = true;
+    };
+
+    struct KeyHashTraits : WTF::SimpleClassHashTraits<Key> { };
+
+    typedef HashMap<Key, float, KeyHash, KeyHashTraits> Map;
+
+    // About 50 bytes an entry. The cache starts over once it is full, which
+    // keeps the words in use and bounds what a font can cost.
+    static const unsigned maxSize = 8192;
+
+    Map m_map;
+
+    static unsigned s_hitCount;
+    static unsigned s_missCount;
+};
+
+} // namespace WebCore
+
+#endif // WidthCache_h
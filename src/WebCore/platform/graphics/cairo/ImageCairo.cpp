@@ -39,12 +39,28 @@
 #include "ImageBuffer.h"
 #include "ImageObserver.h"
 #include "RefPtrCairo.h"
+#include <algorithm>
 #include <cairo.h>
 #include <math.h>
 #include <wtf/OwnPtr.h>
 
 namespace WebCore {
 
+// The size an image must be decoded at so that drawing |srcRect| of it into
+// |dstRect| loses no detail.
+static IntSize sizeNeededToDraw(GraphicsContext* context, const IntSize& imageSize, const FloatRect& dstRect, const FloatRect& srcRect)
+{
+    // Outside of painting the page (canvas, printing, drag images) every
+    // pixel is wanted.
+    if (!ImageSource::PlaceholderScope::isActive())
+        return imageSize;
+
+    AffineTransform ctm = context->getCTM();
+    double width = ceil(fabs(dstRect.width() * ctm.xScale() * imageSize.width() / srcRect.width()));
+    double height = ceil(fabs(dstRect.height() * ctm.yScale() * imageSize.height() / srcRect.height()));
+    return IntSize(static_cast<int>(std::min<double>(width, imageSize.width())), static_cast<int>(std::min<double>(height, imageSize.height())));
+}
+
 bool FrameData::clear(bool clearMetadata)
 {
     if (clearMetadata)
@@ -89,6 +105,7 @@ BitmapImage::BitmapImage(cairo_surface_t* surface, ImageObserver* observer)
     m_frames[0].m_frame = surface;
     m_frames[0].m_hasAlpha = cairo_surface_get_content(surface) != CAIRO_CONTENT_COLOR;
     m_frames[0].m_haveMetadata = true;
+    m_frames[0].m_frameBytes = m_decodedSize;
     checkForSolidColor();
 }
 
@@ -103,6 +120,7 @@ void BitmapImage::draw(GraphicsContext* context, const FloatRect& dst, const Flo
 
     startAnimation();
 
+    requireDecodedSize(sizeNeededToDraw(context, size(), dstRect, srcRect));
     cairo_surface_t* image = frameAtIndex(m_currentFrame);
     if (!image) // If it's too early we won't have an image yet.
         return;
@@ -112,6 +130,12 @@ void BitmapImage::draw(GraphicsContext* context, const FloatRect& dst, const Flo
         return;
     }
 
+    // A frame shrunk while decoding still covers the whole image.
+    IntSize frameSize = currentFrameSize();
+    IntSize surfaceSize(cairo_image_surface_get_width(image), cairo_image_surface_get_height(image));
+    if (surfaceSize != frameSize && !frameSize.isEmpty())
+        srcRect.scale(static_cast<float>(surfaceSize.width()) / frameSize.width(), static_cast<float>(surfaceSize.height()) / frameSize.height());
+
     context->save();
 
     // Set the compositing operation.
@@ -95,6 +95,7 @@ BitmapImage::BitmapImage(CGImageRef cgImage, ImageObserver* observer)
     m_frames[0].m_frame = cgImage;
     m_frames[0].m_hasAlpha = true;
     m_frames[0].m_haveMetadata = true;
+    m_frames[0].m_frameBytes = m_decodedSize;
     checkForSolidColor();
 }
 
@@ -200,6 +200,12 @@ IntSize ImageSource::frameSizeAtIndex(size_t index) const
     return result;
 }
 
+IntSize ImageSource::decodedFrameSizeAtIndex(size_t index) const
+{
+    // ImageIO always decodes at full size.
+    return frameSizeAtIndex(index);
+}
+
 IntSize ImageSource::size() const
 {
     return frameSizeAtIndex(0);
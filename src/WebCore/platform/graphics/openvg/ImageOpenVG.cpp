@@ -81,6 +81,7 @@ BitmapImage::BitmapImage(TiledImageOpenVG* tiledImage, ImageObserver* observer)
     m_frames[0].m_hasAlpha = true;
     m_frames[0].m_isComplete = true;
     m_frames[0].m_haveMetadata = true;
+    m_frames[0].m_frameBytes = m_decodedSize;
     checkForSolidColor();
 }
 
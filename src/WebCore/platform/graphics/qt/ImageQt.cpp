@@ -189,6 +189,7 @@ BitmapImage::BitmapImage(QPixmap* pixmap, ImageObserver* observer)
     m_frames[0].m_frame = pixmap;
     m_frames[0].m_hasAlpha = pixmap->hasAlpha();
     m_frames[0].m_haveMetadata = true;
+    m_frames[0].m_frameBytes = m_decodedSize;
     checkForSolidColor();
 }
 
@@ -302,7 +302,40 @@ template <MatchType type> int getScaledValue(const Vector<int>& scaledValues, in
 
 }
 
+// The rate at which to keep rows or columns of |decodedLength| to shrink
+// |length| by |scale| in all.
+static double remainingScale(double scale, int length, int decodedLength)
+{
+    // The decoding library rounds up when it shrinks the image, so it may
+    // have done all the work already.
+    if (decodedLength <= static_cast<int>(ceil(length * scale)))
+        return 1;
+    return scale * length / decodedLength;
+}
+
+static const int maxScaleDenominator = 8;
+
+int ImageDecoder::desiredScaleDenominator() const
+{
+    if (m_desiredSize.isEmpty())
+        return 1;
+
+    int denominator = 1;
+    while (denominator < maxScaleDenominator) {
+        int next = denominator * 2;
+        if ((m_size.width() + next - 1) / next < m_desiredSize.width() || (m_size.height() + next - 1) / next < m_desiredSize.height())
+            break;
+        denominator = next;
+    }
+    return denominator;
+}
+
 void ImageDecoder::prepareScaleDataIfNecessary()
+{
+    prepareScaleDataIfNecessary(size());
+}
+
+void ImageDecoder::prepareScaleDataIfNecessary(const IntSize& decodedSize)
 {
     m_scaled = false;
     m_scaledColumns.clear();
@@ -310,14 +343,16 @@ void ImageDecoder::prepareScaleDataIfNecessary()
 
     int width = size().width();
     int height = size().height();
+    double scale = 1. / desiredScaleDenominator();
     int numPixels = height * width;
-    if (m_maxNumPixels <= 0 || numPixels <= m_maxNumPixels)
+    if (m_maxNumPixels > 0 && numPixels > m_maxNumPixels)
+        scale = std::min(scale, sqrt(m_maxNumPixels / (double)numPixels));
+    if (scale >= 1 && decodedSize == size())
         return;
 
     m_scaled = true;
-    double scale = sqrt(m_maxNumPixels / (double)numPixels);
-    fillScaledValues(m_scaledColumns, scale, width);
-    fillScaledValues(m_scaledRows, scale, height);
+    fillScaledValues(m_scaledColumns, remainingScale(scale, width, decodedSize.width()), decodedSize.width());
+    fillScaledValues(m_scaledRows, remainingScale(scale, height, decodedSize.height()), decodedSize.height());
 }
 
 int ImageDecoder::upperBoundScaledX(int origX, int searchStart)
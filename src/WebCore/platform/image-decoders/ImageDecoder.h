@@ -216,9 +216,10 @@ namespace WebCore {
     // ImageDecoder is a base for all format-specific decoders
     // (e.g. JPEGImageDecoder).  This base manages the ImageFrame cache.
     //
-    // ENABLE(IMAGE_DECODER_DOWN_SAMPLING) allows image decoders to downsample
-    // at decode time.  Image decoders will downsample any images larger than
-    // |m_maxNumPixels|.  FIXME: Not yet supported by all decoders.
+    // Image decoders may downsample at decode time: to the desired size, see
+    // setDesiredSize(), and with ENABLE(IMAGE_DECODER_DOWN_SAMPLING) any
+    // images larger than |m_maxNumPixels|.  FIXME: Not yet supported by all
+    // decoders.
     class ImageDecoder {
         WTF_MAKE_NONCOPYABLE(ImageDecoder); WTF_MAKE_FAST_ALLOCATED;
     public:
@@ -275,6 +276,22 @@ namespace WebCore {
             return size();
         }
 
+        // The size of the frame buffers, which is smaller than
+        // frameSizeAtIndex() when the image is downsampled while decoding.
+        IntSize decodedFrameSizeAtIndex(size_t index) const
+        {
+            return m_scaled ? scaledSize() : frameSizeAtIndex(index);
+        }
+
+        // Lets the decoder shrink the image by a power of two, down to an
+        // eighth, as long as it stays at least |size| large.  An empty size
+        // decodes at full size.  Must be set before the size is decoded.
+        void setDesiredSize(const IntSize& size) { m_desiredSize = size; }
+
+        // The power of two by which the image is shrunk to suit the desired
+        // size.  Only meaningful once the size is known.
+        int desiredScaleDenominator() const;
+
         // Returns whether the size is legal (i.e. not going to result in
         // overflow elsewhere).  If not, marks decoding as failed.
         virtual bool setSize(unsigned width, unsigned height)
@@ -324,6 +341,9 @@ namespace WebCore {
 
     protected:
         void prepareScaleDataIfNecessary();
+        // |decodedSize| is the size the decoding library produces the image
+        // at, when it can shrink the image itself.
+        void prepareScaleDataIfNecessary(const IntSize& decodedSize);
         int upperBoundScaledX(int origX, int searchStart = 0);
         int lowerBoundScaledX(int origX, int searchStart = 0);
         int upperBoundScaledY(int origY, int searchStart = 0);
@@ -351,6 +371,7 @@ namespace WebCore {
 
         IntSize m_size;
         bool m_sizeAvailable;
+        IntSize m_desiredSize;
         int m_maxNumPixels;
         bool m_isAllDataReceived;
         bool m_failed;
@@ -37,6 +37,7 @@ GIFImageDecoder::GIFImageDecoder(ImageSource::AlphaOption alphaOption,
     , m_alreadyScannedThisDataForFrameCount(true)
     , m_repetitionCount(cAnimationLoopOnce)
     , m_readOffset(0)
+    , m_segmentEnd(0)
 {
 }
 
@@ -84,7 +85,13 @@ size_t GIFImageDecoder::frameCount()
         // all the data.  Note that this is no worse than what ImageIO does on
         // Mac right now (it also crawls all the data again).
         GIFImageReader reader(0);
-        reader.read((const unsigned char*)m_data->data(), m_data->size(), GIFFrameCountQuery, static_cast<unsigned>(-1));
+        const char* segment;
+        unsigned position = 0;
+        while (unsigned length = m_data->getSomeData(segment, position)) {
+            if (reader.read((const unsigned char*)segment, length, GIFFrameCountQuery, static_cast<unsigned>(-1)))
+                break;
+            position += length;
+        }
         m_alreadyScannedThisDataForFrameCount = true;
         m_frameBufferCache.resize(reader.images_count);
         for (int i = 0; i < reader.images_count; ++i)
@@ -189,7 +196,7 @@ void GIFImageDecoder::clearFrameBufferCache(size_t clearBeforeFrame)
 
 void GIFImageDecoder::decodingHalted(unsigned bytesLeft)
 {
-    m_readOffset = m_data->size() - bytesLeft;
+    m_readOffset = m_segmentEnd - bytesLeft;
 }
 
 bool GIFImageDecoder::haveDecodedRow(unsigned frameIndex, unsigned char* rowBuffer, unsigned char* rowEnd, unsigned rowNumber, unsigned repeatCount, bool writeTransparentPixels)
@@ -316,9 +323,23 @@ void GIFImageDecoder::decode(unsigned haltAtFrame, GIFQuery query)
     if (!m_reader)
         m_reader = adoptPtr(new GIFImageReader(this));
 
+    // Feed the reader one segment at a time. It keeps partial blocks across
+    // calls itself, so the data never needs to be merged into one buffer.
+    bool needsMoreData = false;
+    const char* segment;
+    while (unsigned length = m_data->getSomeData(segment, m_readOffset)) {
+        m_segmentEnd = m_readOffset + length;
+        if (m_reader->read((const unsigned char*)segment, length, query, haltAtFrame))
+            return;
+        needsMoreData = true;
+        // Go on only if the reader consumed the whole segment.
+        if (failed() || m_readOffset != m_segmentEnd)
+            break;
+    }
+
     // If we couldn't decode the image but we've received all the data, decoding
     // has failed.
-    if (!m_reader->read((const unsigned char*)m_data->data() + m_readOffset, m_data->size() - m_readOffset, query, haltAtFrame) && isAllDataReceived())
+    if (needsMoreData && isAllDataReceived())
         setFailed();
 }
 
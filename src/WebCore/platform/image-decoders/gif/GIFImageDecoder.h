@@ -78,6 +78,8 @@ namespace WebCore {
         mutable int m_repetitionCount;
         OwnPtr<GIFImageReader> m_reader;
         unsigned m_readOffset;
+        // End of the data segment the reader is currently working on.
+        unsigned m_segmentEnd;
     };
 
 } // namespace WebCore
@@ -246,8 +246,18 @@ public:
             // image is a sequential JPEG.
             m_info.buffered_image = jpeg_has_multiple_scans(&m_info);
 
+            // We can fill in the size now that the header is available.
+            if (!m_decoder->setSize(m_info.image_width, m_info.image_height))
+                return false;
+
+            // Let libjpeg shrink the image in the IDCT, which is far cheaper
+            // than decoding every pixel and then dropping most of them.
+            m_info.scale_num = 1;
+            m_info.scale_denom = m_decoder->desiredScaleDenominator();
+
             // Used to set up image size so arrays can be allocated.
             jpeg_calc_output_dimensions(&m_info);
+            m_decoder->setOutputSize(m_info.output_width, m_info.output_height);
 
             // Make a one-row-high sample array that will go away when done with
             // image. Always make it big enough to hold an RGB row.  Since this
@@ -257,10 +267,6 @@ public:
 
             m_state = JPEG_START_DECOMPRESS;
 
-            // We can fill in the size now that the header is available.
-            if (!m_decoder->setSize(m_info.image_width, m_info.image_height))
-                return false;
-
             if (!m_decoder->ignoresGammaAndColorProfile())
                 m_decoder->setColorProfile(readColorProfile(info()));
 
@@ -431,13 +437,9 @@ bool JPEGImageDecoder::isSizeAvailable()
     return ImageDecoder::isSizeAvailable();
 }
 
-bool JPEGImageDecoder::setSize(unsigned width, unsigned height)
+void JPEGImageDecoder::setOutputSize(unsigned width, unsigned height)
 {
-    if (!ImageDecoder::setSize(width, height))
-        return false;
-
-    prepareScaleDataIfNecessary();
-    return true;
+    prepareScaleDataIfNecessary(IntSize(width, height));
 }
 
 ImageFrame* JPEGImageDecoder::frameBufferAtIndex(size_t index)
@@ -43,13 +43,14 @@ namespace WebCore {
         // ImageDecoder
         virtual String filenameExtension() const { return "jpg"; }
         virtual bool isSizeAvailable();
-        virtual bool setSize(unsigned width, unsigned height);
         virtual ImageFrame* frameBufferAtIndex(size_t index);
         // CAUTION: setFailed() deletes |m_reader|.  Be careful to avoid
         // accessing deleted memory, especially when calling this from inside
         // JPEGImageReader!
         virtual bool setFailed();
 
+        // Called with the size libjpeg decodes to, once it is known.
+        void setOutputSize(unsigned width, unsigned height);
         bool outputScanlines();
         void jpegComplete();
 
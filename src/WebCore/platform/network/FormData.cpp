@@ -134,14 +134,14 @@ PassRefPtr<FormData> FormData::deepCopy() const
             break;
         case FormDataElement::encodedFile:
 #if ENABLE(BLOB)
-            formData->m_elements.append(FormDataElement(e.m_filename, e.m_fileStart, e.m_fileLength, e.m_expectedFileModificationTime, e.m_shouldGenerateFile));
+            formData->m_elements.append(FormDataElement(e.m_filename.crossThreadString(), e.m_fileStart, e.m_fileLength, e.m_expectedFileModificationTime, e.m_shouldGenerateFile));
 #else
-            formData->m_elements.append(FormDataElement(e.m_filename, e.m_shouldGenerateFile));
+            formData->m_elements.append(FormDataElement(e.m_filename.crossThreadString(), e.m_shouldGenerateFile));
 #endif
             break;
 #if ENABLE(BLOB)
         case FormDataElement::encodedBlob:
-            formData->m_elements.append(FormDataElement(e.m_blobURL));
+            formData->m_elements.append(FormDataElement(e.m_blobURL.copy()));
             break;
 #endif
         }
@@ -174,6 +174,13 @@ void ResourceHandle::setDefersLoading(bool defers)
     platformSetDefersLoading(defers);
 }
 
+#if !USE(CURL)
+void ResourceHandle::didChangePriority(ResourceLoadPriority)
+{
+    // Optionally implemented by the platform.
+}
+#endif
+
 #if !USE(SOUP)
 void ResourceHandle::prepareForURL(const KURL& url)
 {
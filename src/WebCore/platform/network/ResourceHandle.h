@@ -30,6 +30,7 @@
 #include "AuthenticationClient.h"
 #include "HTTPHeaderMap.h"
 #include "NetworkingContext.h"
+#include "ResourceLoadPriority.h"
 #include <wtf/OwnPtr.h>
 
 #if USE(SOUP)
@@ -191,6 +192,9 @@ public:
     void setClient(ResourceHandleClient*);
 
     void setDefersLoading(bool);
+
+    // The loader wants this load sooner or later than its request said.
+    void didChangePriority(ResourceLoadPriority);
       
     ResourceRequest& firstRequest();
     const String& lastHTTPMethod() const;
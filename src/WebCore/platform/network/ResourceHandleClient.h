@@ -26,6 +26,7 @@
 #ifndef ResourceHandleClient_h
 #define ResourceHandleClient_h
 
+#include "SharedBuffer.h"
 #include <wtf/CurrentTime.h>
 #include <wtf/RefCounted.h>
 #include <wtf/RefPtr.h>
@@ -75,6 +76,12 @@ namespace WebCore {
 
         virtual void didReceiveResponse(ResourceHandle*, const ResourceResponse&) { }
         virtual void didReceiveData(ResourceHandle*, const char*, int, int /*encodedDataLength*/) { }
+        // Clients that keep the data can hold on to the buffer instead of copying it.
+        virtual void didReceiveBuffer(ResourceHandle* handle, PassRefPtr<SharedBuffer> buffer, int encodedDataLength)
+        {
+            RefPtr<SharedBuffer> protect(buffer);
+            didReceiveData(handle, protect->data(), protect->size(), encodedDataLength);
+        }
         virtual void didReceiveCachedMetadata(ResourceHandle*, const char*, int) { }
         virtual void didFinishLoading(ResourceHandle*, double /*finishTime*/) { }
         virtual void didFail(ResourceHandle*, const ResourceError&) { }
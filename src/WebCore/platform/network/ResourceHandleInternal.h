@@ -76,6 +76,9 @@ class NSURLConnection;
 
 namespace WebCore {
     class ResourceHandleClient;
+#if USE(CURL)
+    struct CurlNetworkJob;
+#endif
 
     class ResourceHandleInternal {
         WTF_MAKE_NONCOPYABLE(ResourceHandleInternal); WTF_MAKE_FAST_ALLOCATED;
@@ -105,7 +108,9 @@ namespace WebCore {
             , m_url(0)
             , m_customHeaders(0)
             , m_cancelled(false)
+            , m_blocksFirstPaint(false)
             , m_formDataStream(loader)
+            , m_networkJob(0)
 #endif
 #if USE(SOUP)
             , m_cancelled(false)
@@ -181,9 +186,14 @@ namespace WebCore {
         struct curl_slist* m_customHeaders;
         ResourceResponse m_response;
         bool m_cancelled;
+        // Taken from the priority the request was issued with. Later priority
+        // changes, such as an image scrolling into view, only reorder the queue.
+        bool m_blocksFirstPaint;
 
         FormDataStream m_formDataStream;
         Vector<char> m_postBytes;
+        // Set while the transfer is owned by the network thread.
+        CurlNetworkJob* m_networkJob;
 #endif
 #if USE(SOUP)
         GRefPtr<SoupMessage> m_soupMessage;
@@ -58,6 +58,10 @@ CURL* curlHandle(const Document* document)
     if (d == NULL)
         return NULL;
 
+    // The handle belongs to the network thread, don't touch it from here.
+    if (d->m_networkJob)
+        return NULL;
+
     return d->m_handle;
 }
 //wke++++++
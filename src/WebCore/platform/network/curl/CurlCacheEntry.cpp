@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "CurlCacheEntry.h"
+
+#include "HTTPParsers.h"
+#include "KURL.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/MD5.h>
+#include <wtf/MathExtras.h>
+#include <wtf/text/CString.h>
+#include <wtf/text/StringBuilder.h>
+
+using namespace std;
+
+namespace WebCore {
+
+static String hashedFileName(const String& url)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    CString urlUTF8 = url.utf8();
+    MD5 md5;
+    md5.addBytes(reinterpret_cast<const uint8_t*>(urlUTF8.data()), urlUTF8.length());
+    Vector<uint8_t, 16> digest;
+    md5.checksum(digest);
+
+    Vector<UChar, 32> hash;
+    for (size_t i = 0; i < digest.size(); ++i) {
+        hash.append(hexDigits[digest[i] >> 4]);
+        hash.append(hexDigits[digest[i] & 0xF]);
+    }
+    return String(hash.data(), hash.size());
+}
+
+CurlCacheEntry::CurlCacheEntry(const String& url, const String& cacheDirectory)
+    : m_url(url)
+    , m_responseTimestamp(0)
+    , m_responseLoaded(false)
+    , m_bodyFile(invalidPlatformFileHandle)
+    , m_headersSize(0)
+    , m_bodySize(0)
+    , m_scriptCacheSize(0)
+    , m_entrySize(0)
+{
+    String fileName = hashedFileName(url);
+    m_headersPath = pathByAppendingComponent(cacheDirectory, fileName + ".headers");
+    m_bodyPath = pathByAppendingComponent(cacheDirectory, fileName + ".body");
+    m_scriptCachePath = pathByAppendingComponent(cacheDirectory, fileName + ".jsfunc");
+}
+
+CurlCacheEntry::~CurlCacheEntry()
+{
+    closeFile(m_bodyFile);
+}
+
+bool CurlCacheEntry::readEntrySize()
+{
+    if (!getFileSize(m_headersPath, m_headersSize) || !getFileSize(m_bodyPath, m_bodySize))
+        return false;
+    if (!getFileSize(m_scriptCachePath, m_scriptCacheSize))
+        m_scriptCacheSize = 0;
+
+    m_entrySize = m_headersSize + m_bodySize + m_scriptCacheSize;
+    return true;
+}
+
+void CurlCacheEntry::setScriptCacheSize(long long size)
+{
+    m_scriptCacheSize = size;
+    m_entrySize = m_headersSize + m_bodySize + m_scriptCacheSize;
+}
+
+bool CurlCacheEntry::loadResponse()
+{
+    if (m_responseLoaded)
+        return true;
+
+    RefPtr<SharedBuffer> buffer = SharedBuffer::createWithContentsOfFile(m_headersPath);
+    if (!buffer)
+        return false;
+
+    Vector<String> lines;
+    String::fromUTF8(buffer->data(), buffer->size()).split('\n', lines);
+    if (lines.size() < 2)
+        return false;
+
+    bool ok;
+    m_responseTimestamp = static_cast<double>(lines[0].toInt64(&ok));
+    if (!ok)
+        return false;
+    int httpCode = lines[1].toInt(&ok);
+    if (!ok)
+        return false;
+
+    ResourceResponse response;
+    for (size_t i = 2; i < lines.size(); ++i) {
+        size_t splitPos = lines[i].find(':');
+        if (splitPos != notFound)
+            response.setHTTPHeaderField(lines[i].left(splitPos), lines[i].substring(splitPos + 1).stripWhiteSpace());
+    }
+
+    response.setURL(KURL(ParsedURLString, m_url));
+    response.setHTTPStatusCode(httpCode);
+    response.setExpectedContentLength(m_bodySize);
+    response.setMimeType(extractMIMETypeFromMediaType(response.httpHeaderField("Content-Type")));
+    response.setTextEncodingName(extractCharsetFromMediaType(response.httpHeaderField("Content-Type")));
+    response.setSuggestedFilename(filenameFromHTTPContentDisposition(response.httpHeaderField("Content-Disposition")));
+
+    m_cachedResponse = response;
+    m_responseLoaded = true;
+    return true;
+}
+
+PassRefPtr<SharedBuffer> CurlCacheEntry::readCachedData() const
+{
+    if (!m_bodySize)
+        return SharedBuffer::create();
+    return SharedBuffer::createWithContentsOfFile(m_bodyPath);
+}
+
+static double currentAge(const ResourceResponse& response, double responseTimestamp)
+{
+    // RFC2616 13.2.3
+    // No compensation for latency as that is not terribly important in practice
+    double dateValue = response.date();
+    double apparentAge = isfinite(dateValue) ? max(0., responseTimestamp - dateValue) : 0;
+    double ageValue = response.age();
+    double correctedReceivedAge = isfinite(ageValue) ? max(apparentAge, ageValue) : apparentAge;
+    double residentTime = currentTime() - responseTimestamp;
+    return correctedReceivedAge + residentTime;
+}
+
+double CurlCacheEntry::freshnessLifetime(const ResourceResponse& response, double responseTimestamp)
+{
+    // RFC2616 13.2.4
+    double maxAgeValue = response.cacheControlMaxAge();
+    if (isfinite(maxAgeValue))
+        return maxAgeValue;
+    double expiresValue = response.expires();
+    double dateValue = response.date();
+    double creationTime = isfinite(dateValue) ? dateValue : responseTimestamp;
+    if (isfinite(expiresValue))
+        return expiresValue - creationTime;
+    double lastModifiedValue = response.lastModified();
+    if (isfinite(lastModifiedValue))
+        return (creationTime - lastModifiedValue) * 0.1;
+    return 0;
+}
+
+bool CurlCacheEntry::isFresh() const
+{
+    ASSERT(m_responseLoaded);
+    if (m_cachedResponse.cacheControlContainsNoCache() || m_cachedResponse.cacheControlContainsMustRevalidate())
+        return false;
+    return currentAge(m_cachedResponse, m_responseTimestamp) <= freshnessLifetime(m_cachedResponse, m_responseTimestamp);
+}
+
+bool CurlCacheEntry::hasValidators() const
+{
+    return !eTag().isEmpty() || !lastModified().isEmpty();
+}
+
+String CurlCacheEntry::eTag() const
+{
+    return m_cachedResponse.httpHeaderField("ETag");
+}
+
+String CurlCacheEntry::lastModified() const
+{
+    return m_cachedResponse.httpHeaderField("Last-Modified");
+}
+
+bool CurlCacheEntry::writeHeaders()
+{
+    StringBuilder builder;
+    builder.append(String::number(static_cast<long long>(m_responseTimestamp)));
+    builder.append('\n');
+    builder.append(String::number(m_cachedResponse.httpStatusCode()));
+    builder.append('\n');
+
+    const HTTPHeaderMap& headers = m_cachedResponse.httpHeaderFields();
+    HTTPHeaderMap::const_iterator end = headers.end();
+    for (HTTPHeaderMap::const_iterator it = headers.begin(); it != end; ++it) {
+        builder.append(it->first);
+        builder.append(": ");
+        builder.append(it->second);
+        builder.append('\n');
+    }
+
+    CString headersUTF8 = builder.toString().utf8();
+    PlatformFileHandle headersFile = openFile(m_headersPath, OpenForWrite);
+    if (!isHandleValid(headersFile))
+        return false;
+    int written = writeToFile(headersFile, headersUTF8.data(), headersUTF8.length());
+    closeFile(headersFile);
+    if (written != static_cast<int>(headersUTF8.length()))
+        return false;
+
+    m_headersSize = headersUTF8.length();
+    return true;
+}
+
+bool CurlCacheEntry::beginWrite(const ResourceResponse& response)
+{
+    ASSERT(!isHandleValid(m_bodyFile));
+
+    m_cachedResponse = response;
+    m_responseTimestamp = currentTime();
+    m_responseLoaded = false;
+    m_bodySize = 0;
+    m_entrySize = 0;
+
+    // The function cache of a previous body is of no use for this one.
+    deleteFile(m_scriptCachePath);
+    m_scriptCacheSize = 0;
+
+    m_bodyFile = openFile(m_bodyPath, OpenForWrite);
+    if (!isHandleValid(m_bodyFile))
+        return false;
+    return writeHeaders();
+}
+
+bool CurlCacheEntry::appendData(const char* data, size_t length)
+{
+    if (!isHandleValid(m_bodyFile))
+        return false;
+    if (writeToFile(m_bodyFile, data, length) != static_cast<int>(length))
+        return false;
+
+    m_bodySize += length;
+    return true;
+}
+
+bool CurlCacheEntry::finishWrite()
+{
+    if (!isHandleValid(m_bodyFile))
+        return false;
+    closeFile(m_bodyFile);
+
+    m_cachedResponse.setExpectedContentLength(m_bodySize);
+    m_entrySize = m_headersSize + m_bodySize + m_scriptCacheSize;
+    m_responseLoaded = true;
+    return true;
+}
+
+void CurlCacheEntry::abortWrite()
+{
+    // Only delete files we actually created; another job may own them.
+    if (!isHandleValid(m_bodyFile))
+        return;
+    closeFile(m_bodyFile);
+    invalidate();
+}
+
+bool CurlCacheEntry::updateResponse(const ResourceResponse& notModifiedResponse)
+{
+    if (!loadResponse())
+        return false;
+
+    // RFC2616 10.3.5: the 304 carries the headers that changed. It describes
+    // no body, so keep the entity headers we stored with the original.
+    const HTTPHeaderMap& headers = notModifiedResponse.httpHeaderFields();
+    HTTPHeaderMap::const_iterator end = headers.end();
+    for (HTTPHeaderMap::const_iterator it = headers.begin(); it != end; ++it) {
+        if (equalIgnoringCase(it->first, "Content-Length")
+            || equalIgnoringCase(it->first, "Content-Type")
+            || equalIgnoringCase(it->first, "Content-Encoding")
+            || equalIgnoringCase(it->first, "Transfer-Encoding"))
+            continue;
+        m_cachedResponse.setHTTPHeaderField(it->first, it->second);
+    }
+
+    m_responseTimestamp = currentTime();
+    if (!writeHeaders())
+        return false;
+
+    m_entrySize = m_headersSize + m_bodySize + m_scriptCacheSize;
+    return true;
+}
+
+void CurlCacheEntry::invalidate()
+{
+    deleteFile(m_headersPath);
+    deleteFile(m_bodyPath);
+    deleteFile(m_scriptCachePath);
+    m_responseLoaded = false;
+    m_headersSize = 0;
+    m_bodySize = 0;
+    m_scriptCacheSize = 0;
+    m_entrySize = 0;
+}
+
+} // namespace WebCore
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CurlCacheEntry_h
+#define CurlCacheEntry_h
+
+#include "FileSystem.h"
+#include "PlatformString.h"
+#include "ResourceResponse.h"
+#include "SharedBuffer.h"
+#include <wtf/PassOwnPtr.h>
+#include <wtf/PassRefPtr.h>
+
+namespace WebCore {
+
+// One response in the disk cache. It is stored as two files named after the
+// MD5 of the URL: "<hash>.headers" holds the time the response was received,
+// the status code and the header fields, "<hash>.body" holds the decoded body
+// exactly as it was handed to the client. A script may also have
+// "<hash>.jsfunc", the JavaScript parser's function cache for its body.
+class CurlCacheEntry {
+    WTF_MAKE_NONCOPYABLE(CurlCacheEntry); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static PassOwnPtr<CurlCacheEntry> create(const String& url, const String& cacheDirectory)
+    {
+        return adoptPtr(new CurlCacheEntry(url, cacheDirectory));
+    }
+    ~CurlCacheEntry();
+
+    const String& url() const { return m_url; }
+    const String& headersPath() const { return m_headersPath; }
+    const String& bodyPath() const { return m_bodyPath; }
+    const String& scriptCachePath() const { return m_scriptCachePath; }
+
+    // Size of all files on disk; what counts against the storage limit.
+    long long entrySize() const { return m_entrySize; }
+    long long bodySize() const { return m_bodySize; }
+    long long scriptCacheSize() const { return m_scriptCacheSize; }
+    void setScriptCacheSize(long long);
+    bool readEntrySize();
+
+    // The stored response, read from disk the first time it is needed.
+    bool loadResponse();
+    const ResourceResponse& cachedResponse() const { return m_cachedResponse; }
+    PassRefPtr<SharedBuffer> readCachedData() const;
+
+    // RFC 2616 13.2, the same rules CachedResource applies to the memory cache.
+    bool isFresh() const;
+    bool hasValidators() const;
+    String eTag() const;
+    String lastModified() const;
+
+    // Storing a new response. The entry is only usable once finishWrite()
+    // returns true; abortWrite() removes whatever was written so far.
+    bool beginWrite(const ResourceResponse&);
+    bool appendData(const char* data, size_t length);
+    bool finishWrite();
+    void abortWrite();
+
+    // Refreshes the stored headers from a 304 Not Modified response.
+    bool updateResponse(const ResourceResponse& notModifiedResponse);
+
+    // Deletes all files.
+    void invalidate();
+
+    static double freshnessLifetime(const ResourceResponse&, double responseTimestamp);
+
+private:
+    CurlCacheEntry(const String& url, const String& cacheDirectory);
+
+    bool writeHeaders();
+
+    String m_url;
+    String m_headersPath;
+    String m_bodyPath;
+    String m_scriptCachePath;
+
+    ResourceResponse m_cachedResponse;
+    double m_responseTimestamp;
+    bool m_responseLoaded;
+
+    PlatformFileHandle m_bodyFile;
+    long long m_headersSize;
+    long long m_bodySize;
+    long long m_scriptCacheSize;
+    long long m_entrySize;
+};
+
+} // namespace WebCore
+
+#endif // CurlCacheEntry_h
@@ -0,0 +1,581 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "CurlCacheManager.h"
+
+#include "CurlCacheEntry.h"
+#include "FileSystem.h"
+#include "ResourceHandle.h"
+#include "ResourceHandleInternal.h"
+#include "ResourceRequest.h"
+#include "ResourceResponse.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/MainThread.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/text/CString.h>
+#include <wtf/text/StringBuilder.h>
+
+namespace WebCore {
+
+// Coalesces index writes while a page is loading.
+const double saveIndexDelay = 2;
+
+struct CurlCacheManager::Transfer {
+    WTF_MAKE_NONCOPYABLE(Transfer); WTF_MAKE_FAST_ALLOCATED;
+public:
+    Transfer(const String& url)
+        : url(url)
+        , revalidating(false)
+        , notModified(false)
+    {
+    }
+
+    String url;
+    bool revalidating;
+    bool notModified;
+    OwnPtr<CurlCacheEntry> pendingEntry;
+};
+
+// Owned by the script cache thread from writeScriptCache() until it is handed
+// back to didWriteScriptCache() on the main thread.
+struct CurlCacheManager::ScriptCacheWrite {
+    WTF_MAKE_NONCOPYABLE(ScriptCacheWrite); WTF_MAKE_FAST_ALLOCATED;
+public:
+    ScriptCacheWrite(const String& url, const String& path, PassOwnPtr<Vector<char> > data)
+        : url(url.crossThreadString())
+        , path(path.crossThreadString())
+        , data(data)
+        , written(false)
+    {
+    }
+
+    String url;
+    String path;
+    OwnPtr<Vector<char> > data;
+    bool written;
+};
+
+static String cacheKey(const KURL& url)
+{
+    KURL key = url;
+    key.removeFragmentIdentifier();
+    return key.string();
+}
+
+static bool isCacheableRequest(const ResourceRequest& request)
+{
+    if (request.httpMethod() != "GET" || !request.url().protocolInHTTPFamily())
+        return false;
+
+    // Conditional requests come from the memory cache revalidating its own
+    // copy; the server's answer has to reach it unchanged.
+    return request.httpHeaderField("If-None-Match").isEmpty()
+        && request.httpHeaderField("If-Modified-Since").isEmpty()
+        && request.httpHeaderField("If-Match").isEmpty()
+        && request.httpHeaderField("If-Unmodified-Since").isEmpty()
+        && request.httpHeaderField("If-Range").isEmpty()
+        && request.httpHeaderField("Range").isEmpty();
+}
+
+CurlCacheManager& CurlCacheManager::getInstance()
+{
+    DEFINE_STATIC_LOCAL(CurlCacheManager, instance, ());
+    return instance;
+}
+
+CurlCacheManager::CurlCacheManager()
+    : m_storageSizeLimit(0)
+    , m_currentStorageSize(0)
+    , m_saveIndexTimer(this, &CurlCacheManager::saveIndexTimerFired)
+    , m_scriptCacheThread(0)
+{
+}
+
+CurlCacheManager::~CurlCacheManager()
+{
+    m_scriptCacheWrites.kill();
+    saveIndex();
+    clearEntries();
+}
+
+void CurlCacheManager::setCacheDirectory(const String& directory)
+{
+    if (directory == m_cacheDirectory)
+        return;
+
+    if (m_saveIndexTimer.isActive())
+        saveIndex();
+    clearEntries();
+
+    m_cacheDirectory = directory;
+    if (m_cacheDirectory.isEmpty())
+        return;
+
+    if (!makeAllDirectories(m_cacheDirectory)) {
+        LOG_ERROR("Could not create the disk cache directory %s", m_cacheDirectory.utf8().data());
+        m_cacheDirectory = String();
+        return;
+    }
+    loadIndex();
+}
+
+void CurlCacheManager::setStorageSizeLimit(long long limit)
+{
+    m_storageSizeLimit = limit;
+    evictEntries();
+}
+
+void CurlCacheManager::loadIndex()
+{
+    String indexPath = pathByAppendingComponent(m_cacheDirectory, "index.dat");
+    HashSet<String> knownFiles;
+
+    RefPtr<SharedBuffer> buffer = SharedBuffer::createWithContentsOfFile(indexPath);
+    if (buffer) {
+        Vector<String> urls;
+        String::fromUTF8(buffer->data(), buffer->size()).split('\n', urls);
+        for (size_t i = 0; i < urls.size(); ++i) {
+            if (m_index.contains(urls[i]))
+                continue;
+
+            OwnPtr<CurlCacheEntry> entry = CurlCacheEntry::create(urls[i], m_cacheDirectory);
+            if (!entry->readEntrySize()) {
+                entry->invalidate();
+                continue;
+            }
+            knownFiles.add(pathGetFileName(entry->headersPath()));
+            knownFiles.add(pathGetFileName(entry->bodyPath()));
+            knownFiles.add(pathGetFileName(entry->scriptCachePath()));
+            m_index.set(entry->url(), entry.get());
+            m_LRUEntryList.add(entry->url());
+            m_currentStorageSize += entry->entrySize();
+            entry.leakPtr();
+        }
+    }
+
+    // Entries that never made it into the index were being written when the
+    // process went away.
+    Vector<String> paths = listDirectory(m_cacheDirectory, "*");
+    for (size_t i = 0; i < paths.size(); ++i) {
+        String fileName = pathGetFileName(paths[i]);
+        if (!fileName.endsWith(".headers") && !fileName.endsWith(".body") && !fileName.endsWith(".jsfunc"))
+            continue;
+        if (!knownFiles.contains(fileName))
+            deleteFile(paths[i]);
+    }
+
+    evictEntries();
+}
+
+void CurlCacheManager::saveIndex()
+{
+    m_saveIndexTimer.stop();
+    if (m_cacheDirectory.isEmpty())
+        return;
+
+    StringBuilder builder;
+    ListHashSet<String>::const_iterator end = m_LRUEntryList.end();
+    for (ListHashSet<String>::const_iterator it = m_LRUEntryList.begin(); it != end; ++it) {
+        builder.append(*it);
+        builder.append('\n');
+    }
+
+    CString index = builder.toString().utf8();
+    PlatformFileHandle indexFile = openFile(pathByAppendingComponent(m_cacheDirectory, "index.dat"), OpenForWrite);
+    if (!isHandleValid(indexFile))
+        return;
+    writeToFile(indexFile, index.data(), index.length());
+    closeFile(indexFile);
+}
+
+void CurlCacheManager::saveIndexTimerFired(Timer<CurlCacheManager>*)
+{
+    saveIndex();
+}
+
+void CurlCacheManager::scheduleSaveIndex()
+{
+    if (!m_saveIndexTimer.isActive())
+        m_saveIndexTimer.startOneShot(saveIndexDelay);
+}
+
+bool CurlCacheManager::serveFromCache(ResourceHandle* job)
+{
+    if (!isEnabled())
+        return false;
+
+    const ResourceRequest& request = job->firstRequest();
+    if (!isCacheableRequest(request) || request.cachePolicy() == ResourceRequest::ReloadIgnoringCacheData)
+        return false;
+
+    ResourceHandleInternal* d = job->getInternal();
+    if (d->m_defersLoading)
+        return false;
+
+    String url = cacheKey(request.url());
+    CurlCacheEntry* entry = m_index.get(url);
+    if (!entry)
+        return false;
+    if (!entry->loadResponse()) {
+        invalidateEntry(url);
+        return false;
+    }
+
+    // Back/forward navigations and the like take whatever we have.
+    bool allowStaleData = request.cachePolicy() == ResourceRequest::ReturnCacheDataElseLoad
+        || request.cachePolicy() == ResourceRequest::ReturnCacheDataDontLoad;
+    if (!allowStaleData && !entry->isFresh())
+        return false;
+
+    RefPtr<SharedBuffer> data = entry->readCachedData();
+    if (!data) {
+        invalidateEntry(url);
+        return false;
+    }
+    touchEntry(url);
+
+    d->m_response = entry->cachedResponse();
+    if (d->client())
+        d->client()->didReceiveResponse(job, d->m_response);
+    d->m_response.setResponseFired(true);
+
+    if (!d->m_cancelled && d->client() && data->size())
+        d->client()->didReceiveBuffer(job, data.release(), 0);
+
+    if (!d->m_cancelled && d->client())
+        d->client()->didFinishLoading(job, 0);
+    return true;
+}
+
+void CurlCacheManager::willStartTransfer(ResourceHandle* job, struct curl_slist** headers)
+{
+    const ResourceRequest& request = job->firstRequest();
+    if (!isEnabled() || !isCacheableRequest(request))
+        return;
+
+    ASSERT(!m_transfers.contains(job));
+    Transfer* transfer = new Transfer(cacheKey(request.url()));
+    m_transfers.set(job, transfer);
+
+    if (request.cachePolicy() == ResourceRequest::ReloadIgnoringCacheData)
+        return;
+
+    CurlCacheEntry* entry = m_index.get(transfer->url);
+    if (!entry || !entry->loadResponse() || !entry->hasValidators())
+        return;
+
+    String eTag = entry->eTag();
+    if (!eTag.isEmpty())
+        *headers = curl_slist_append(*headers, String("If-None-Match: " + eTag).latin1().data());
+    String lastModified = entry->lastModified();
+    if (!lastModified.isEmpty())
+        *headers = curl_slist_append(*headers, String("If-Modified-Since: " + lastModified).latin1().data());
+
+    transfer->revalidating = true;
+    m_revalidatingURLs.add(transfer->url);
+}
+
+bool CurlCacheManager::isCacheable(const Transfer& transfer, const ResourceResponse& response) const
+{
+    if (response.httpStatusCode() != 200)
+        return false;
+
+    // A redirected response belongs to another URL.
+    if (cacheKey(response.url()) != transfer.url)
+        return false;
+
+    if (response.cacheControlContainsNoStore())
+        return false;
+
+    // curl always asks for a compressed body, so that is the only variant we
+    // can tell apart.
+    String vary = response.httpHeaderField("Vary").stripWhiteSpace();
+    if (!vary.isEmpty() && !equalIgnoringCase(vary, "Accept-Encoding"))
+        return false;
+
+    // Replaying the response would not set the cookie again.
+    if (!response.httpHeaderField("Set-Cookie").isEmpty())
+        return false;
+
+    if (response.expectedContentLength() > maximumEntrySize())
+        return false;
+
+    // Useless unless it can be served as is or revalidated later.
+    return CurlCacheEntry::freshnessLifetime(response, currentTime()) > 0
+        || !response.httpHeaderField("ETag").isEmpty()
+        || !response.httpHeaderField("Last-Modified").isEmpty();
+}
+
+void CurlCacheManager::didReceiveResponse(ResourceHandle* job, ResourceResponse& response)
+{
+    Transfer* transfer = m_transfers.get(job);
+    if (!transfer)
+        return;
+
+    if (transfer->revalidating) {
+        if (response.httpStatusCode() == 304) {
+            // Pinned by m_revalidatingURLs, so only a change of cache
+            // directory or a damaged entry can take it away.
+            CurlCacheEntry* entry = m_index.get(transfer->url);
+            long long oldSize = entry ? entry->entrySize() : 0;
+            if (entry && entry->updateResponse(response)) {
+                m_currentStorageSize += entry->entrySize() - oldSize;
+                KURL responseURL = response.url();
+                response = entry->cachedResponse();
+                response.setURL(responseURL);
+                transfer->notModified = true;
+                touchEntry(transfer->url);
+                return;
+            }
+            // The client gets the 304 as the server sent it.
+            m_revalidatingURLs.remove(transfer->url);
+            transfer->revalidating = false;
+            invalidateEntry(transfer->url);
+            return;
+        }
+
+        // Whatever came back replaces the stored copy.
+        m_revalidatingURLs.remove(transfer->url);
+        transfer->revalidating = false;
+        if (!m_revalidatingURLs.contains(transfer->url))
+            invalidateEntry(transfer->url);
+    }
+
+    if (!isCacheable(*transfer, response) || m_writingURLs.contains(transfer->url)) {
+        discardTransfer(m_transfers.take(job));
+        return;
+    }
+
+    if (m_index.contains(transfer->url)) {
+        if (m_revalidatingURLs.contains(transfer->url)) {
+            discardTransfer(m_transfers.take(job));
+            return;
+        }
+        invalidateEntry(transfer->url);
+    }
+
+    OwnPtr<CurlCacheEntry> entry = CurlCacheEntry::create(transfer->url, m_cacheDirectory);
+    if (!entry->beginWrite(response)) {
+        entry->abortWrite();
+        discardTransfer(m_transfers.take(job));
+        return;
+    }
+    transfer->pendingEntry = entry.release();
+    m_writingURLs.add(transfer->url);
+}
+
+void CurlCacheManager::didReceiveData(ResourceHandle* job, const char* data, size_t length)
+{
+    Transfer* transfer = m_transfers.get(job);
+    if (!transfer || !transfer->pendingEntry)
+        return;
+
+    if (transfer->pendingEntry->bodySize() + static_cast<long long>(length) <= maximumEntrySize()
+        && transfer->pendingEntry->appendData(data, length))
+        return;
+
+    discardTransfer(m_transfers.take(job));
+}
+
+void CurlCacheManager::didFinishLoading(ResourceHandle* job)
+{
+    // Take the transfer out first, the client may cancel the job from
+    // didReceiveData().
+    Transfer* transfer = m_transfers.take(job);
+    if (!transfer)
+        return;
+
+    if (transfer->notModified) {
+        CurlCacheEntry* entry = m_index.get(transfer->url);
+        RefPtr<SharedBuffer> data = entry ? entry->readCachedData() : 0;
+        ResourceHandleInternal* d = job->getInternal();
+        if (data && data->size() && !d->m_cancelled && d->client())
+            d->client()->didReceiveBuffer(job, data.release(), 0);
+    } else if (transfer->pendingEntry) {
+        m_writingURLs.remove(transfer->url);
+        OwnPtr<CurlCacheEntry> entry = transfer->pendingEntry.release();
+        if (entry->finishWrite())
+            addEntry(entry.leakPtr());
+        else
+            entry->abortWrite();
+    }
+
+    discardTransfer(transfer);
+}
+
+void CurlCacheManager::didFail(ResourceHandle* job)
+{
+    discardTransfer(m_transfers.take(job));
+}
+
+void CurlCacheManager::discardTransfer(Transfer* transfer)
+{
+    if (!transfer)
+        return;
+
+    if (transfer->revalidating)
+        m_revalidatingURLs.remove(transfer->url);
+    if (transfer->pendingEntry) {
+        m_writingURLs.remove(transfer->url);
+        transfer->pendingEntry->abortWrite();
+    }
+    delete transfer;
+
+    // Eviction skips entries that are being revalidated; catch up now.
+    if (m_currentStorageSize > m_storageSizeLimit)
+        evictEntries();
+}
+
+void CurlCacheManager::addEntry(CurlCacheEntry* entry)
+{
+    ASSERT(!m_index.contains(entry->url()));
+    m_index.set(entry->url(), entry);
+    m_LRUEntryList.add(entry->url());
+    m_currentStorageSize += entry->entrySize();
+
+    evictEntries();
+    scheduleSaveIndex();
+}
+
+void CurlCacheManager::touchEntry(const String& url)
+{
+    m_LRUEntryList.remove(url);
+    m_LRUEntryList.add(url);
+    scheduleSaveIndex();
+}
+
+void CurlCacheManager::invalidateEntry(const String& url)
+{
+    CurlCacheEntry* entry = m_index.take(url);
+    if (!entry)
+        return;
+
+    m_LRUEntryList.remove(url);
+    m_currentStorageSize -= entry->entrySize();
+    entry->invalidate();
+    delete entry;
+    scheduleSaveIndex();
+}
+
+void CurlCacheManager::evictEntries()
+{
+    Vector<String> victims;
+    long long storageSize = m_currentStorageSize;
+    ListHashSet<String>::const_iterator end = m_LRUEntryList.end();
+    for (ListHashSet<String>::const_iterator it = m_LRUEntryList.begin(); it != end && storageSize > m_storageSizeLimit; ++it) {
+        if (m_revalidatingURLs.contains(*it))
+            continue;
+        storageSize -= m_index.get(*it)->entrySize();
+        victims.append(*it);
+    }
+
+    for (size_t i = 0; i < victims.size(); ++i)
+        invalidateEntry(victims[i]);
+}
+
+String CurlCacheManager::scriptCachePath(const KURL& url) const
+{
+    CurlCacheEntry* entry = m_index.get(cacheKey(url));
+    return entry ? entry->scriptCachePath() : String();
+}
+
+void CurlCacheManager::writeScriptCache(const KURL& url, PassOwnPtr<Vector<char> > data)
+{
+    String key = cacheKey(url);
+    CurlCacheEntry* entry = m_index.get(key);
+    if (!entry)
+        return;
+
+    if (!m_scriptCacheThread)
+        m_scriptCacheThread = createThread(scriptCacheThreadStart, this, "WebCore: Script cache");
+    if (!m_scriptCacheThread)
+        return;
+    m_scriptCacheWrites.append(adoptPtr(new ScriptCacheWrite(key, entry->scriptCachePath(), data)));
+}
+
+void* CurlCacheManager::scriptCacheThreadStart(void* context)
+{
+    static_cast<CurlCacheManager*>(context)->scriptCacheThreadLoop();
+    return 0;
+}
+
+void CurlCacheManager::scriptCacheThreadLoop()
+{
+    while (OwnPtr<ScriptCacheWrite> write = m_scriptCacheWrites.waitForMessage()) {
+        PlatformFileHandle file = openFile(write->path, OpenForWrite);
+        if (isHandleValid(file)) {
+            int written = writeToFile(file, write->data->data(), write->data->size());
+            closeFile(file);
+            write->written = written == static_cast<int>(write->data->size());
+        }
+        // A partial file would fail to decode anyway.
+        if (!write->written)
+            deleteFile(write->path);
+        callOnMainThread(didWriteScriptCache, write.leakPtr());
+    }
+}
+
+void CurlCacheManager::didWriteScriptCache(void* context)
+{
+    OwnPtr<ScriptCacheWrite> write = adoptPtr(static_cast<ScriptCacheWrite*>(context));
+    getInstance().didWriteScriptCache(write.get());
+}
+
+void CurlCacheManager::didWriteScriptCache(ScriptCacheWrite* write)
+{
+    CurlCacheEntry* entry = m_index.get(write->url);
+    if (!entry || entry->scriptCachePath() != write->path) {
+        // The entry was evicted, or the cache moved, while the file was written.
+        deleteFile(write->path);
+        return;
+    }
+
+    long long oldSize = entry->entrySize();
+    entry->setScriptCacheSize(write->written ? write->data->size() : 0);
+    m_currentStorageSize += entry->entrySize() - oldSize;
+    evictEntries();
+}
+
+void CurlCacheManager::clearEntries()
+{
+    // Transfers still writing into the old directory give up; revalidations
+    // keep their pin and fall back to the plain server response.
+    HashMap<ResourceHandle*, Transfer*>::iterator end = m_transfers.end();
+    for (HashMap<ResourceHandle*, Transfer*>::iterator it = m_transfers.begin(); it != end; ++it) {
+        if (it->second->pendingEntry) {
+            it->second->pendingEntry->abortWrite();
+            it->second->pendingEntry.clear();
+        }
+    }
+    m_writingURLs.clear();
+
+    deleteAllValues(m_index);
+    m_index.clear();
+    m_LRUEntryList.clear();
+    m_currentStorageSize = 0;
+}
+
+} // namespace WebCore
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2026 The miniwebkit authors.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CurlCacheManager_h
+#define CurlCacheManager_h
+
+#include "PlatformString.h"
+#include "Timer.h"
+#include <wtf/HashCountedSet.h>
+#include <wtf/HashMap.h>
+#include <wtf/HashSet.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/MessageQueue.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringHash.h>
+
+struct curl_slist;
+
+namespace WebCore {
+
+class CurlCacheEntry;
+class KURL;
+class ResourceHandle;
+class ResourceResponse;
+
+// Persistent HTTP cache for the curl backend. Responses to GET requests are
+// kept in a directory on disk, bounded by a storage limit and evicted least
+// recently used first. The index is a list of URLs, oldest first, rewritten
+// shortly after it changes.
+//
+// ResourceHandleManager drives it from the main thread only: fresh entries
+// are answered without touching the network, stale ones are revalidated with
+// If-None-Match / If-Modified-Since and a 304 is turned back into the stored
+// response.
+class CurlCacheManager {
+    WTF_MAKE_NONCOPYABLE(CurlCacheManager); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static CurlCacheManager& getInstance();
+
+    // An empty directory or a zero limit disables the cache.
+    void setCacheDirectory(const String&);
+    const String& cacheDirectory() const { return m_cacheDirectory; }
+    void setStorageSizeLimit(long long);
+    long long storageSizeLimit() const { return m_storageSizeLimit; }
+    long long currentStorageSize() const { return m_currentStorageSize; }
+    bool isEnabled() const { return !m_cacheDirectory.isEmpty() && m_storageSizeLimit > 0; }
+
+    // Answers the job from the cache, calling the client synchronously.
+    // Returns false if the job has to go to the network.
+    bool serveFromCache(ResourceHandle*);
+
+    // Called once the curl handle is set up; adds the validators of a
+    // stale entry to the request headers.
+    void willStartTransfer(ResourceHandle*, struct curl_slist** headers);
+
+    // Called right before the matching client callback. On a 304 the
+    // response is replaced with the stored one and didFinishLoading()
+    // replays the stored body.
+    void didReceiveResponse(ResourceHandle*, ResourceResponse&);
+    void didReceiveData(ResourceHandle*, const char* data, size_t length);
+    void didFinishLoading(ResourceHandle*);
+
+    // Drops whatever the job was writing. Safe to call for any job.
+    void didFail(ResourceHandle*);
+
+    void saveIndex();
+
+    // The JavaScript parser's function cache of a script is kept next to the
+    // script's entry. It counts against the storage limit and is evicted with
+    // the entry. The path is empty if the URL has no entry.
+    String scriptCachePath(const KURL&) const;
+    // Writes the file on a background thread; the storage size is updated
+    // on the main thread once it has been written.
+    void writeScriptCache(const KURL&, PassOwnPtr<Vector<char> >);
+
+private:
+    struct Transfer;
+    struct ScriptCacheWrite;
+
+    CurlCacheManager();
+    ~CurlCacheManager();
+
+    void loadIndex();
+    void saveIndexTimerFired(Timer<CurlCacheManager>*);
+    void scheduleSaveIndex();
+
+    void discardTransfer(Transfer*);
+    bool isCacheable(const Transfer&, const ResourceResponse&) const;
+    long long maximumEntrySize() const { return m_storageSizeLimit / 8; }
+    void addEntry(CurlCacheEntry*);
+    void touchEntry(const String& url);
+    void invalidateEntry(const String& url);
+    void evictEntries();
+    void clearEntries();
+
+    static void* scriptCacheThreadStart(void*);
+    void scriptCacheThreadLoop();
+    static void didWriteScriptCache(void*);
+    void didWriteScriptCache(ScriptCacheWrite*);
+
+    String m_cacheDirectory;
+    long long m_storageSizeLimit;
+    long long m_currentStorageSize;
+
+    HashMap<String, CurlCacheEntry*> m_index;
+    ListHashSet<String> m_LRUEntryList;
+    HashMap<ResourceHandle*, Transfer*> m_transfers;
+    // URLs some job is writing a new entry for, and URLs whose entry a
+    // revalidation still needs; neither is replaced nor evicted meanwhile.
+    HashSet<String> m_writingURLs;
+    HashCountedSet<String> m_revalidatingURLs;
+    Timer<CurlCacheManager> m_saveIndexTimer;
+
+    ThreadIdentifier m_scriptCacheThread;
+    MessageQueue<ScriptCacheWrite> m_scriptCacheWrites;
+};
+
+} // namespace WebCore
+
+#endif // CurlCacheManager_h
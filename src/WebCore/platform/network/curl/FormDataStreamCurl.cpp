@@ -43,20 +43,26 @@ FormDataStream::~FormDataStream()
         fclose(m_file);
 }
 
+FormData* FormDataStream::formData() const
+{
+    if (m_formData)
+        return m_formData.get();
+    return m_resourceHandle->firstRequest().httpBody();
+}
+
 size_t FormDataStream::read(void* ptr, size_t blockSize, size_t numberOfBlocks)
 {
     // Check for overflow.
     if (!numberOfBlocks || blockSize > std::numeric_limits<size_t>::max() / numberOfBlocks)
         return 0;
 
-    Vector<FormDataElement> elements;
-    if (m_resourceHandle->firstRequest().httpBody())
-        elements = m_resourceHandle->firstRequest().httpBody()->elements();
-
-    if (m_formDataElementIndex >= elements.size())
+    FormData* body = formData();
+    if (!body || m_formDataElementIndex >= body->elements().size())
         return 0;
 
-    FormDataElement element = elements[m_formDataElementIndex];
+    // Don't copy the element: a stream fed by setFormData() may be read off
+    // the main thread and must not touch the strings' reference counts.
+    const FormDataElement& element = body->elements()[m_formDataElementIndex];
 
     size_t toSend = blockSize * numberOfBlocks;
     size_t sent;
@@ -103,11 +109,8 @@ size_t FormDataStream::read(void* ptr, size_t blockSize, size_t numberOfBlocks)
 
 bool FormDataStream::hasMoreElements() const
 {
-    Vector<FormDataElement> elements;
-    if (m_resourceHandle->firstRequest().httpBody())
-        elements = m_resourceHandle->firstRequest().httpBody()->elements();
-
-    return m_formDataElementIndex < elements.size();
+    FormData* body = formData();
+    return body && m_formDataElementIndex < body->elements().size();
 }
 
 } // namespace WebCore
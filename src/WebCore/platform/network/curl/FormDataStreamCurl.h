@@ -28,8 +28,10 @@
 #include "config.h"
 
 #include "FileSystem.h"
+#include "FormData.h"
 #include "ResourceHandle.h"
 #include <stdio.h>
+#include <wtf/RefPtr.h>
 
 namespace WebCore {
 
@@ -48,10 +50,17 @@ public:
     size_t read(void* ptr, size_t blockSize, size_t numberOfBlocks);
     bool hasMoreElements() const;
 
+    // Reads from this copy of the request body instead of the ResourceHandle's
+    // request, so that the body can be streamed from another thread.
+    void setFormData(PassRefPtr<FormData> formData) { m_formData = formData; }
+
 private:
+    FormData* formData() const;
+
     // We can hold a weak reference to our ResourceHandle as it holds a strong reference
     // to us through its ResourceHandleInternal.
     ResourceHandle* m_resourceHandle;
+    RefPtr<FormData> m_formData;
 
     FILE* m_file;
     size_t m_formDataElementIndex;
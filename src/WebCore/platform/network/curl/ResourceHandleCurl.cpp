@@ -114,6 +114,11 @@ void ResourceHandle::cancel()
     ResourceHandleManager::sharedInstance()->cancel(this);
 }
 
+void ResourceHandle::didChangePriority(ResourceLoadPriority priority)
+{
+    ResourceHandleManager::sharedInstance()->setPriority(this, priority);
+}
+
 #if PLATFORM(WIN) && USE(CF)
 static HashSet<String>& allowsAnyHTTPSCertificateHosts()
 {
@@ -149,6 +154,11 @@ void ResourceHandle::platformSetDefersLoading(bool defers)
     if (!d->m_handle)
         return;
 
+    if (d->m_networkJob) {
+        ResourceHandleManager::sharedInstance()->setDefersLoading(this, defers);
+        return;
+    }
+
     if (defers) {
         CURLcode error = curl_easy_pause(d->m_handle, CURLPAUSE_ALL);
         // If we could not defer the handle, so don't do it.
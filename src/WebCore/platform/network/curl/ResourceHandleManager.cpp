@@ -34,6 +34,7 @@
 #include "config.h"
 #include "ResourceHandleManager.h"
 
+#include "CurlCacheManager.h"
 #include "DataURL.h"
 #include "HTTPParsers.h"
 #include "MIMETypeRegistry.h"
@@ -41,12 +42,19 @@
 #include "ResourceError.h"
 #include "ResourceHandle.h"
 #include "ResourceHandleInternal.h"
+#include "SharedBuffer.h"
+#if USE(CURL_MULTI_SOCKET)
+#include "WebCoreInstanceHandle.h"
+#endif
 
 #include <errno.h>
 #include <stdio.h>
 #if USE(CF)
 #include <wtf/RetainPtr.h>
 #endif
+#include <wtf/MainThread.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/PassOwnPtr.h>
 #include <wtf/Threading.h>
 #include <wtf/Vector.h>
 #include <wtf/text/CString.h>
@@ -65,8 +73,19 @@ namespace WebCore {
 //wke++++++
 const int selectTimeoutMS = 1;
 const double pollTimeSeconds = 0.01;
-const int maxRunningJobs = 5;
+// Enough to keep several hosts busy; maxConnectionsPerHost is what limits a
+// single origin.
+const int maxRunningJobs = 24;
 //wke++++++
+// Per host, like other browsers; jobs beyond that wait inside curl for a
+// free connection, or share one once it turns out to speak HTTP/2.
+const long maxConnectionsPerHost = 6;
+// Idle connections kept open for reuse.
+const long maxCachedConnections = 32;
+// Images and other low priority loads allowed to run while a style sheet,
+// script or font is still loading.
+const int maxLowPriorityJobsWhileBlocking = 2;
+const int networkThreadPollTimeoutMS = 1000;
 
 static const bool ignoreSSLErrors = getenv("WEBKIT_IGNORE_SSL_ERRORS");
 
@@ -93,6 +112,7 @@ static CString certificatePath()
 static Mutex* sharedResourceMutex(curl_lock_data data) {
     DEFINE_STATIC_LOCAL(Mutex, cookieMutex, ());
     DEFINE_STATIC_LOCAL(Mutex, dnsMutex, ());
+    DEFINE_STATIC_LOCAL(Mutex, sslSessionMutex, ());
     DEFINE_STATIC_LOCAL(Mutex, shareMutex, ());
 
     switch (data) {
@@ -100,6 +120,8 @@ static Mutex* sharedResourceMutex(curl_lock_data data) {
             return &cookieMutex;
         case CURL_LOCK_DATA_DNS:
             return &dnsMutex;
+        case CURL_LOCK_DATA_SSL_SESSION:
+            return &sslSessionMutex;
         case CURL_LOCK_DATA_SHARE:
             return &shareMutex;
         default:
@@ -109,8 +131,8 @@ static Mutex* sharedResourceMutex(curl_lock_data data) {
 }
 
 // libcurl does not implement its own thread synchronization primitives.
-// these two functions provide mutexes for cookies, and for the global DNS
-// cache.
+// these two functions provide mutexes for cookies, the global DNS cache
+// and the TLS session cache.
 static void curl_lock_callback(CURL* handle, curl_lock_data data, curl_lock_access access, void* userPtr)
 {
     if (Mutex* mutex = sharedResourceMutex(data))
@@ -124,23 +146,60 @@ static void curl_unlock_callback(CURL* handle, curl_lock_data data, void* userPt
 }
 
 ResourceHandleManager::ResourceHandleManager()
-    : m_downloadTimer(this, &ResourceHandleManager::downloadTimerCallback)
+#if USE(CURL_MULTI_SOCKET)
+    : m_socketWindowHandle(0)
+    , m_startJobsTimer(this, &ResourceHandleManager::startJobsTimerCallback)
+#else
+    : m_startJobsTimer(this, &ResourceHandleManager::startJobsTimerCallback)
+#endif
+    , m_downloadTimer(this, &ResourceHandleManager::downloadTimerCallback)
     , m_cookieJarFileName(0)
     , m_certificatePath (certificatePath())
     , m_runningJobs(0)
-
+    , m_runningBlockingJobs(0)
+    , m_runningLowPriorityJobs(0)
+    , m_usesNetworkThread(false)
+    , m_networkThread(0)
+    , m_cookieHandle(0)
+    , m_supportsHTTP2(false)
 {
     curl_global_init(CURL_GLOBAL_ALL);
     m_curlMultiHandle = curl_multi_init();
     m_curlShareHandle = curl_share_init();
     curl_share_setopt(m_curlShareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_COOKIE);
     curl_share_setopt(m_curlShareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    // Lets a new connection to a known server resume the TLS session instead
+    // of doing a full handshake, including for synchronous loads.
+    curl_share_setopt(m_curlShareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
     curl_share_setopt(m_curlShareHandle, CURLSHOPT_LOCKFUNC, curl_lock_callback);
     curl_share_setopt(m_curlShareHandle, CURLSHOPT_UNLOCKFUNC, curl_unlock_callback);
+
+    // Every job runs on m_curlMultiHandle, whose connection cache hands
+    // finished connections to the next job for the same host. The
+    // connection cache is deliberately not put in the share handle: libcurl
+    // does not support using it from the network thread and a synchronous
+    // load on the main thread at once.
+    curl_multi_setopt(m_curlMultiHandle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(m_curlMultiHandle, CURLMOPT_MAX_HOST_CONNECTIONS, maxConnectionsPerHost);
+    curl_multi_setopt(m_curlMultiHandle, CURLMOPT_MAXCONNECTS, maxCachedConnections);
+    m_supportsHTTP2 = curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2;
+#if USE(CURL_MULTI_SOCKET)
+    initializeSocketWindow();
+    curl_multi_setopt(m_curlMultiHandle, CURLMOPT_SOCKETFUNCTION, curlSocketCallback);
+    curl_multi_setopt(m_curlMultiHandle, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(m_curlMultiHandle, CURLMOPT_TIMERFUNCTION, curlTimerCallback);
+    curl_multi_setopt(m_curlMultiHandle, CURLMOPT_TIMERDATA, this);
+#endif
 }
 
 ResourceHandleManager::~ResourceHandleManager()
 {
+#if USE(CURL_MULTI_SOCKET)
+    if (m_socketWindowHandle)
+        DestroyWindow(m_socketWindowHandle);
+#endif
+    if (m_cookieHandle)
+        curl_easy_cleanup(m_cookieHandle);
     curl_multi_cleanup(m_curlMultiHandle);
     curl_share_cleanup(m_curlShareHandle);
     if (m_cookieJarFileName)
@@ -208,6 +267,7 @@ static size_t writeCallback(void* ptr, size_t size, size_t nmemb, void* data)
             return 0;
     }
 
+    CurlCacheManager::getInstance().didReceiveData(job, static_cast<char*>(ptr), totalSize);
     if (d->client())
         d->client()->didReceiveData(job, static_cast<char*>(ptr), totalSize, 0);
     return totalSize;
@@ -285,6 +345,7 @@ static size_t headerCallback(char* ptr, size_t size, size_t nmemb, void* data)
             }
         }
 
+        CurlCacheManager::getInstance().didReceiveResponse(job, d->m_response);
         if (client)
             client->didReceiveResponse(job, d->m_response);
         d->m_response.setResponseFired(true);
@@ -333,6 +394,103 @@ size_t readCallback(void* ptr, size_t size, size_t nmemb, void* data)
     return sent;
 }
 
+#if USE(CURL_MULTI_SOCKET)
+static UINT socketEventMessage;
+const LPCWSTR kSocketWindowClassName = L"CurlSocketWindowClass";
+
+void ResourceHandleManager::initializeSocketWindow()
+{
+    WNDCLASSEX wcex;
+    memset(&wcex, 0, sizeof(WNDCLASSEX));
+    wcex.cbSize = sizeof(WNDCLASSEX);
+    wcex.lpfnWndProc    = socketWindowWndProc;
+    wcex.hInstance      = instanceHandle();
+    wcex.lpszClassName  = kSocketWindowClassName;
+    RegisterClassEx(&wcex);
+
+    m_socketWindowHandle = CreateWindow(kSocketWindowClassName, 0, 0,
+       CW_USEDEFAULT, 0, CW_USEDEFAULT, 0, HWND_MESSAGE, 0, instanceHandle(), 0);
+    socketEventMessage = RegisterWindowMessage(L"com.wke.CurlSocketEvent");
+}
+
+// Winsock posts socketEventMessage to the socket window whenever a socket
+// that curl asked us to watch becomes readable or writable, so nothing runs
+// on the main thread while the network is idle.
+LRESULT CALLBACK ResourceHandleManager::socketWindowWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    if (message != socketEventMessage || !socketEventMessage)
+        return DefWindowProc(hWnd, message, wParam, lParam);
+
+    int eventMask = 0;
+    switch (WSAGETSELECTEVENT(lParam)) {
+    case FD_READ:
+    case FD_CLOSE:
+        eventMask = CURL_CSELECT_IN;
+        break;
+    case FD_WRITE:
+    case FD_CONNECT:
+        eventMask = CURL_CSELECT_OUT;
+        break;
+    }
+    if (WSAGETSELECTERROR(lParam))
+        eventMask |= CURL_CSELECT_ERR;
+
+    sharedInstance()->socketAction(static_cast<curl_socket_t>(wParam), eventMask);
+    return 0;
+}
+
+int ResourceHandleManager::curlSocketCallback(CURL*, curl_socket_t socket, int what, void* userp, void*)
+{
+    ResourceHandleManager* manager = static_cast<ResourceHandleManager*>(userp);
+
+    long events = 0;
+    switch (what) {
+    case CURL_POLL_IN:
+        events = FD_READ | FD_CLOSE;
+        break;
+    case CURL_POLL_OUT:
+        events = FD_WRITE | FD_CONNECT | FD_CLOSE;
+        break;
+    case CURL_POLL_INOUT:
+        events = FD_READ | FD_WRITE | FD_CONNECT | FD_CLOSE;
+        break;
+    case CURL_POLL_REMOVE:
+        break;
+    }
+
+    // Re-registering also re-arms FD_WRITE, so a socket that is already
+    // writable is reported again when curl starts waiting for it.
+    WSAAsyncSelect(socket, manager->m_socketWindowHandle, events ? socketEventMessage : 0, events);
+    return 0;
+}
+
+int ResourceHandleManager::curlTimerCallback(CURLM*, long timeoutMS, void* userp)
+{
+    ResourceHandleManager* manager = static_cast<ResourceHandleManager*>(userp);
+
+    if (timeoutMS < 0)
+        manager->m_downloadTimer.stop();
+    else
+        manager->m_downloadTimer.startOneShot(timeoutMS / 1000.0);
+    return 0;
+}
+
+void ResourceHandleManager::socketAction(curl_socket_t socket, int eventMask)
+{
+    int runningHandles = 0;
+    curl_multi_socket_action(m_curlMultiHandle, socket, eventMask, &runningHandles);
+
+    processMessages();
+    startScheduledJobs(); // new jobs might have been added in the meantime
+}
+
+void ResourceHandleManager::downloadTimerCallback(Timer<ResourceHandleManager>*)
+{
+    // curl's own timeout expired.
+    socketAction(CURL_SOCKET_TIMEOUT, 0);
+}
+
+#else
 void ResourceHandleManager::downloadTimerCallback(Timer<ResourceHandleManager>* timer)
 {
     startScheduledJobs();
@@ -370,6 +528,67 @@ void ResourceHandleManager::downloadTimerCallback(Timer<ResourceHandleManager>*
     int runningHandles = 0;
     while (curl_multi_perform(m_curlMultiHandle, &runningHandles) == CURLM_CALL_MULTI_PERFORM) { }
 
+    processMessages();
+
+    bool started = startScheduledJobs(); // new jobs might have been added in the meantime
+
+    if (!m_downloadTimer.isActive() && (started || (runningHandles > 0)))
+        m_downloadTimer.startOneShot(pollTimeSeconds);
+}
+#endif
+
+void ResourceHandleManager::startJobsTimerCallback(Timer<ResourceHandleManager>*)
+{
+#if USE(CURL_MULTI_SOCKET)
+    while (!m_cancelledJobs.isEmpty())
+        removeFromCurl(m_cancelledJobs.last());
+#endif
+
+    // Adding a handle makes curl request an immediate timeout through
+    // curlTimerCallback, which performs the first step of the transfer.
+    startScheduledJobs();
+}
+
+ResourceHandleManager::ConnectionStatistics ResourceHandleManager::connectionStatistics() const
+{
+    MutexLocker locker(m_statisticsMutex);
+    return m_connectionStatistics;
+}
+
+void ResourceHandleManager::resetConnectionStatistics()
+{
+    MutexLocker locker(m_statisticsMutex);
+    m_connectionStatistics = ConnectionStatistics();
+}
+
+void ResourceHandleManager::recordConnectionStatistics(CURL* handle)
+{
+    // Local files and transfers that never got a response.
+    long httpVersion = CURL_HTTP_VERSION_NONE;
+    curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &httpVersion);
+    if (httpVersion == CURL_HTTP_VERSION_NONE)
+        return;
+
+    long connects = 0;
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+    curl_off_t appConnectTime = 0;
+    curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &appConnectTime);
+
+    MutexLocker locker(m_statisticsMutex);
+    m_connectionStatistics.transfers++;
+    if (connects)
+        m_connectionStatistics.newConnections += connects;
+    else
+        m_connectionStatistics.reusedConnections++;
+    // Reset for every transfer, so only set if this one did the handshake.
+    if (appConnectTime > 0)
+        m_connectionStatistics.tlsHandshakes++;
+    if (httpVersion == CURL_HTTP_VERSION_2_0)
+        m_connectionStatistics.http2Transfers++;
+}
+
+void ResourceHandleManager::processMessages()
+{
     // check the curl messages indicating completed transfers
     // and free their resources
     while (true) {
@@ -398,6 +617,7 @@ void ResourceHandleManager::downloadTimerCallback(Timer<ResourceHandleManager>*
         if (CURLMSG_DONE != msg->msg)
             continue;
 
+        recordConnectionStatistics(handle);
         if (CURLE_OK == msg->data.result) {
             if (!d->m_response.responseFired()) {
                 handleLocalReceiveResponse(d->m_handle, job, d);
@@ -407,6 +627,13 @@ void ResourceHandleManager::downloadTimerCallback(Timer<ResourceHandleManager>*
                 }
             }
 
+            // Replays the stored body if the server answered 304.
+            CurlCacheManager::getInstance().didFinishLoading(job);
+            if (d->m_cancelled) {
+                removeFromCurl(job);
+                continue;
+            }
+
             if (d->client())
                 d->client()->didFinishLoading(job, 0);
         } else {
@@ -421,11 +648,493 @@ void ResourceHandleManager::downloadTimerCallback(Timer<ResourceHandleManager>*
 
         removeFromCurl(job);
     }
+}
 
-    bool started = startScheduledJobs(); // new jobs might have been added in the meantime
+// A transfer owned by the network thread. The curl callbacks below parse the
+// response on the network thread and queue what the client has to see; the
+// main thread replays the queue in deliverPendingNetworkEvents().
+struct CurlNetworkJob {
+    WTF_MAKE_NONCOPYABLE(CurlNetworkJob); WTF_MAKE_FAST_ALLOCATED;
+public:
+    struct Redirect {
+        KURL url;
+        OwnPtr<CrossThreadResourceResponseData> response;
+    };
+
+    CurlNetworkJob(ResourceHandle* job)
+        : job(job)
+        , handle(0)
+        , url(job->firstRequest().url().copy())
+        , formDataStream(0)
+        , responseFired(false)
+        , removed(false)
+        , finished(false)
+        , result(CURLE_OK)
+        , pendingCommands(0)
+        , deliveryScheduled(false)
+        , delivering(false)
+    {
+    }
 
-    if (!m_downloadTimer.isActive() && (started || (runningHandles > 0)))
-        m_downloadTimer.startOneShot(pollTimeSeconds);
+    // Owned by the main thread, which holds a reference on it until
+    // finishNetworkJob(); the network thread must not dereference it.
+    ResourceHandle* job;
+    CURL* handle;
+
+    // Only touched by the network thread once the job has been handed over
+    // to it; the main thread sets them up in startJob() before that.
+    KURL url;
+    FormDataStream formDataStream;
+    ResourceResponse response;
+    bool responseFired;
+
+    // Guarded by ResourceHandleManager::m_networkMutex.
+    Vector<OwnPtr<Redirect> > redirects;
+    OwnPtr<CrossThreadResourceResponseData> pendingResponse;
+    Vector<char> pendingData;
+    bool removed;
+    bool finished;
+    CURLcode result;
+    String errorURL;
+    unsigned pendingCommands;
+    bool deliveryScheduled;
+
+    // Only touched by the main thread.
+    bool delivering;
+};
+
+static void setNetworkResponseURL(CurlNetworkJob* networkJob)
+{
+    const char* hdr;
+    CURLcode err = curl_easy_getinfo(networkJob->handle, CURLINFO_EFFECTIVE_URL, &hdr);
+    ASSERT_UNUSED(err, CURLE_OK == err);
+    networkJob->response.setURL(KURL(KURL(), hdr));
+}
+
+// Network thread counterpart of writeCallback.
+static size_t networkWriteCallback(void* ptr, size_t size, size_t nmemb, void* data)
+{
+    CurlNetworkJob* networkJob = static_cast<CurlNetworkJob*>(data);
+    ResourceHandleManager* manager = ResourceHandleManager::sharedInstance();
+    size_t totalSize = size * nmemb;
+
+    long httpCode = 0;
+    CURLcode err = curl_easy_getinfo(networkJob->handle, CURLINFO_RESPONSE_CODE, &httpCode);
+    if (CURLE_OK == err && httpCode >= 300 && httpCode < 400)
+        return totalSize;
+
+    manager->queueNetworkData(networkJob, static_cast<char*>(ptr), totalSize);
+    return totalSize;
+}
+
+// Network thread counterpart of headerCallback.
+static size_t networkHeaderCallback(char* ptr, size_t size, size_t nmemb, void* data)
+{
+    CurlNetworkJob* networkJob = static_cast<CurlNetworkJob*>(data);
+    ResourceHandleManager* manager = ResourceHandleManager::sharedInstance();
+    size_t totalSize = size * nmemb;
+    ResourceResponse& response = networkJob->response;
+
+    String header(static_cast<const char*>(ptr), totalSize);
+    if (header == String("\r\n") || header == String("\n")) {
+        CURL* h = networkJob->handle;
+
+        double contentLength = 0;
+        curl_easy_getinfo(h, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &contentLength);
+        response.setExpectedContentLength(static_cast<long long int>(contentLength));
+
+        setNetworkResponseURL(networkJob);
+
+        long httpCode = 0;
+        curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &httpCode);
+        response.setHTTPStatusCode(httpCode);
+
+        response.setMimeType(extractMIMETypeFromMediaType(response.httpHeaderField("Content-Type")));
+        response.setTextEncodingName(extractCharsetFromMediaType(response.httpHeaderField("Content-Type")));
+        response.setSuggestedFilename(filenameFromHTTPContentDisposition(response.httpHeaderField("Content-Disposition")));
+
+        if (httpCode >= 300 && httpCode < 400) {
+            String location = response.httpHeaderField("location");
+            if (!location.isEmpty()) {
+                networkJob->url = KURL(networkJob->url, location);
+                manager->queueNetworkRedirect(networkJob);
+                return totalSize;
+            }
+        }
+
+        manager->queueNetworkResponse(networkJob);
+    } else {
+        int splitPos = header.find(":");
+        if (splitPos != -1)
+            response.setHTTPHeaderField(header.left(splitPos), header.substring(splitPos+1).stripWhiteSpace());
+    }
+
+    return totalSize;
+}
+
+// Network thread counterpart of readCallback.
+static size_t networkReadCallback(void* ptr, size_t size, size_t nmemb, void* data)
+{
+    CurlNetworkJob* networkJob = static_cast<CurlNetworkJob*>(data);
+
+    if (!size || !nmemb)
+        return 0;
+
+    if (!networkJob->formDataStream.hasMoreElements())
+        return 0;
+
+    size_t sent = networkJob->formDataStream.read(ptr, size, nmemb);
+
+    // Something went wrong so abort the transfer; the client sees didFail.
+    if (!sent)
+        return CURL_READFUNC_ABORT;
+
+    return sent;
+}
+
+void ResourceHandleManager::setUsesNetworkThread(bool usesNetworkThread)
+{
+    // Switching while transfers are in flight would leave them on the wrong
+    // thread, and the network thread runs until the process exits.
+    ASSERT(!m_runningJobs);
+    if (!usesNetworkThread || m_usesNetworkThread || m_runningJobs)
+        return;
+
+    m_usesNetworkThread = true;
+    m_cookieHandle = curl_easy_init();
+    curl_easy_setopt(m_cookieHandle, CURLOPT_SHARE, m_curlShareHandle);
+#if USE(CURL_MULTI_SOCKET)
+    // The network thread polls the multi handle itself.
+    curl_multi_setopt(m_curlMultiHandle, CURLMOPT_SOCKETFUNCTION, 0);
+    curl_multi_setopt(m_curlMultiHandle, CURLMOPT_TIMERFUNCTION, 0);
+#endif
+    m_downloadTimer.stop();
+    m_networkThread = createThread(networkThreadStart, this, "WebCore: Network");
+}
+
+void* ResourceHandleManager::networkThreadStart(void* context)
+{
+    static_cast<ResourceHandleManager*>(context)->networkThreadLoop();
+    return 0;
+}
+
+void ResourceHandleManager::networkThreadLoop()
+{
+    while (true) {
+        processNetworkCommands();
+
+        int runningHandles = 0;
+        curl_multi_perform(m_curlMultiHandle, &runningHandles);
+        processNetworkMessages();
+
+        // Hand everything received in this iteration to the main thread at once.
+        {
+            MutexLocker locker(m_networkMutex);
+            for (size_t i = 0; i < m_dirtyNetworkJobs.size(); ++i) {
+                CurlNetworkJob* networkJob = m_dirtyNetworkJobs[i];
+                // Once removed is set the main thread may release the job, so
+                // this is the last time we look at it unless a command is pending.
+                if (!networkJob->handle)
+                    networkJob->removed = true;
+                scheduleNetworkDelivery(networkJob);
+            }
+        }
+        m_dirtyNetworkJobs.clear();
+
+        // Sleeps until a socket is ready, curl's timeout expires or
+        // postNetworkCommand() wakes us up.
+        curl_multi_poll(m_curlMultiHandle, 0, 0, networkThreadPollTimeoutMS, 0);
+    }
+}
+
+void ResourceHandleManager::postNetworkCommand(NetworkCommandType type, CurlNetworkJob* networkJob)
+{
+    ASSERT(isMainThread());
+    {
+        MutexLocker locker(m_networkMutex);
+        NetworkCommand command = { type, networkJob };
+        m_networkCommands.append(command);
+        networkJob->pendingCommands++;
+    }
+    curl_multi_wakeup(m_curlMultiHandle);
+}
+
+void ResourceHandleManager::processNetworkCommands()
+{
+    Vector<NetworkCommand> commands;
+    {
+        MutexLocker locker(m_networkMutex);
+        commands.swap(m_networkCommands);
+    }
+
+    for (size_t i = 0; i < commands.size(); ++i) {
+        CurlNetworkJob* networkJob = commands[i].networkJob;
+        if (networkJob->handle) {
+            switch (commands[i].type) {
+            case AddJobCommand:
+                if (curl_multi_add_handle(m_curlMultiHandle, networkJob->handle) != CURLM_OK)
+                    removeFromNetworkThread(networkJob);
+                break;
+            case CancelJobCommand:
+                removeFromNetworkThread(networkJob);
+                break;
+            case PauseJobCommand:
+                curl_easy_pause(networkJob->handle, CURLPAUSE_ALL);
+                break;
+            case ResumeJobCommand:
+                // Restarting the handle has failed so just cancel it.
+                if (curl_easy_pause(networkJob->handle, CURLPAUSE_CONT) != CURLE_OK)
+                    removeFromNetworkThread(networkJob);
+                break;
+            }
+        }
+
+        MutexLocker locker(m_networkMutex);
+        // The main thread only releases the job once every command has been seen.
+        if (!--networkJob->pendingCommands && networkJob->removed)
+            scheduleNetworkDelivery(networkJob);
+    }
+}
+
+void ResourceHandleManager::processNetworkMessages()
+{
+    while (true) {
+        int messagesInQueue;
+        CURLMsg* msg = curl_multi_info_read(m_curlMultiHandle, &messagesInQueue);
+        if (!msg)
+            break;
+
+        if (CURLMSG_DONE != msg->msg)
+            continue;
+
+        CurlNetworkJob* networkJob = 0;
+        CURLcode err = curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &networkJob);
+        ASSERT_UNUSED(err, CURLE_OK == err);
+        ASSERT(networkJob);
+        if (!networkJob)
+            continue;
+
+        recordConnectionStatistics(msg->easy_handle);
+        CURLcode result = msg->data.result;
+        if (CURLE_OK == result && !networkJob->responseFired) {
+            // Local files never go through networkHeaderCallback.
+            setNetworkResponseURL(networkJob);
+            queueNetworkResponse(networkJob);
+        }
+
+        String errorURL;
+        if (CURLE_OK != result) {
+            char* url = 0;
+            curl_easy_getinfo(networkJob->handle, CURLINFO_EFFECTIVE_URL, &url);
+            errorURL = String(url).crossThreadString();
+#ifndef NDEBUG
+            fprintf(stderr, "Curl ERROR for url='%s', error: '%s'\n", url, curl_easy_strerror(result));
+#endif
+        }
+
+        {
+            MutexLocker locker(m_networkMutex);
+            networkJob->finished = true;
+            networkJob->result = result;
+            networkJob->errorURL = errorURL;
+        }
+        removeFromNetworkThread(networkJob);
+    }
+}
+
+void ResourceHandleManager::removeFromNetworkThread(CurlNetworkJob* networkJob)
+{
+    curl_multi_remove_handle(m_curlMultiHandle, networkJob->handle);
+    curl_easy_cleanup(networkJob->handle);
+    networkJob->handle = 0;
+    // The header map holds strings from this thread's atomic string table.
+    networkJob->response = ResourceResponse();
+
+    if (!m_dirtyNetworkJobs.contains(networkJob))
+        m_dirtyNetworkJobs.append(networkJob);
+}
+
+void ResourceHandleManager::queueNetworkRedirect(CurlNetworkJob* networkJob)
+{
+    OwnPtr<CurlNetworkJob::Redirect> redirect = adoptPtr(new CurlNetworkJob::Redirect);
+    redirect->url = networkJob->url.copy();
+    redirect->response = networkJob->response.copyData();
+
+    MutexLocker locker(m_networkMutex);
+    networkJob->redirects.append(redirect.release());
+    if (!m_dirtyNetworkJobs.contains(networkJob))
+        m_dirtyNetworkJobs.append(networkJob);
+}
+
+void ResourceHandleManager::queueNetworkResponse(CurlNetworkJob* networkJob)
+{
+    networkJob->responseFired = true;
+    OwnPtr<CrossThreadResourceResponseData> response = networkJob->response.copyData();
+
+    MutexLocker locker(m_networkMutex);
+    networkJob->pendingResponse = response.release();
+    if (!m_dirtyNetworkJobs.contains(networkJob))
+        m_dirtyNetworkJobs.append(networkJob);
+}
+
+void ResourceHandleManager::queueNetworkData(CurlNetworkJob* networkJob, const char* data, size_t length)
+{
+    if (!networkJob->responseFired) {
+        setNetworkResponseURL(networkJob);
+        queueNetworkResponse(networkJob);
+    }
+
+    MutexLocker locker(m_networkMutex);
+    networkJob->pendingData.append(data, length);
+    if (!m_dirtyNetworkJobs.contains(networkJob))
+        m_dirtyNetworkJobs.append(networkJob);
+}
+
+// Called with m_networkMutex held.
+void ResourceHandleManager::scheduleNetworkDelivery(CurlNetworkJob* networkJob)
+{
+    if (networkJob->deliveryScheduled)
+        return;
+    networkJob->deliveryScheduled = true;
+    callOnMainThread(deliverNetworkJob, networkJob);
+}
+
+void ResourceHandleManager::deliverNetworkJob(void* context)
+{
+    sharedInstance()->deliverPendingNetworkEvents(static_cast<CurlNetworkJob*>(context));
+}
+
+void ResourceHandleManager::deliverPendingNetworkEvents(CurlNetworkJob* networkJob)
+{
+    ASSERT(isMainThread());
+
+    {
+        MutexLocker locker(m_networkMutex);
+        networkJob->deliveryScheduled = false;
+    }
+
+    // A client callback that spins a nested run loop must not deliver out of
+    // order or release the job under us; the outer loop picks up the rest.
+    if (networkJob->delivering)
+        return;
+    networkJob->delivering = true;
+
+    ResourceHandle* job = networkJob->job;
+    ResourceHandleInternal* d = job->getInternal();
+    bool released = false;
+
+    while (true) {
+        OwnPtr<CurlNetworkJob::Redirect> redirect;
+        OwnPtr<CrossThreadResourceResponseData> response;
+        Vector<char> data;
+        bool finished = false;
+        CURLcode result = CURLE_OK;
+        String errorURL;
+        {
+            MutexLocker locker(m_networkMutex);
+
+            if (d->m_cancelled) {
+                networkJob->redirects.clear();
+                networkJob->pendingResponse.clear();
+                networkJob->pendingData.clear();
+                networkJob->finished = false;
+            } else if (d->m_defersLoading) {
+                // Held back until setDefersLoading(job, false).
+                break;
+            }
+
+            // Deliver one event at a time, in the order curl produced them.
+            if (!networkJob->redirects.isEmpty()) {
+                redirect = networkJob->redirects[0].release();
+                networkJob->redirects.remove(0);
+            } else if (networkJob->pendingResponse)
+                response = networkJob->pendingResponse.release();
+            else if (!networkJob->pendingData.isEmpty())
+                data.swap(networkJob->pendingData);
+            else if (networkJob->finished) {
+                finished = true;
+                networkJob->finished = false;
+                result = networkJob->result;
+                errorURL = networkJob->errorURL;
+            } else {
+                // A delivery still queued on the main thread will release it instead.
+                released = networkJob->removed && !networkJob->pendingCommands && !networkJob->deliveryScheduled;
+                break;
+            }
+        }
+
+        ResourceHandleClient* client = d->client();
+        if (redirect) {
+            OwnPtr<ResourceResponse> redirectResponse = ResourceResponse::adopt(redirect->response.release());
+            ResourceRequest redirectedRequest = job->firstRequest();
+            redirectedRequest.setURL(redirect->url);
+            if (client)
+                client->willSendRequest(job, redirectedRequest, *redirectResponse);
+            d->m_firstRequest.setURL(redirect->url);
+        } else if (response) {
+            d->m_response = *ResourceResponse::adopt(response.release());
+            CurlCacheManager::getInstance().didReceiveResponse(job, d->m_response);
+            if (client)
+                client->didReceiveResponse(job, d->m_response);
+            d->m_response.setResponseFired(true);
+            //wke++++++
+            {
+                MutexLocker cookieLocker(*sharedResourceMutex(CURL_LOCK_DATA_COOKIE));
+                cookieJar.set(m_cookieHandle);
+            }
+            //wke++++++
+        } else if (!data.isEmpty()) {
+            CurlCacheManager::getInstance().didReceiveData(job, data.data(), data.size());
+            // Hand the chunk over as is, the loader keeps it without copying.
+            if (client)
+                client->didReceiveBuffer(job, SharedBuffer::adoptVector(data), 0);
+        } else if (finished) {
+            if (CURLE_OK == result) {
+                CurlCacheManager::getInstance().didFinishLoading(job);
+                client = d->m_cancelled ? 0 : d->client();
+            }
+            if (!client)
+                continue;
+            if (CURLE_OK == result)
+                client->didFinishLoading(job, 0);
+            else
+                client->didFail(job, ResourceError(String(), result, errorURL, String(curl_easy_strerror(result))));
+        }
+    }
+
+    networkJob->delivering = false;
+    if (released)
+        finishNetworkJob(networkJob);
+}
+
+void ResourceHandleManager::finishNetworkJob(CurlNetworkJob* networkJob)
+{
+    ResourceHandle* job = networkJob->job;
+    ResourceHandleInternal* d = job->getInternal();
+
+    removeRunningJob(job);
+    CurlCacheManager::getInstance().didFail(job);
+    d->m_handle = 0;
+    d->m_networkJob = 0;
+    delete networkJob;
+    job->deref();
+
+    if (!m_resourceHandleList.isEmpty() && !m_startJobsTimer.isActive())
+        m_startJobsTimer.startOneShot(0);
+}
+
+void ResourceHandleManager::setDefersLoading(ResourceHandle* job, bool defers)
+{
+    ResourceHandleInternal* d = job->getInternal();
+    if (!d->m_networkJob)
+        return;
+
+    postNetworkCommand(defers ? PauseJobCommand : ResumeJobCommand, d->m_networkJob);
+    if (!defers) {
+        // Flush whatever was held back while loading was deferred.
+        MutexLocker locker(m_networkMutex);
+        scheduleNetworkDelivery(d->m_networkJob);
+    }
 }
 
 void ResourceHandleManager::setProxyInfo(const String& host,
@@ -453,7 +1162,13 @@ void ResourceHandleManager::removeFromCurl(ResourceHandle* job)
     ASSERT(d->m_handle);
     if (!d->m_handle)
         return;
-    m_runningJobs--;
+#if USE(CURL_MULTI_SOCKET)
+    size_t cancelledIndex = m_cancelledJobs.find(job);
+    if (cancelledIndex != notFound)
+        m_cancelledJobs.remove(cancelledIndex);
+#endif
+    removeRunningJob(job);
+    CurlCacheManager::getInstance().didFail(job);
     curl_multi_remove_handle(m_curlMultiHandle, d->m_handle);
     curl_easy_cleanup(d->m_handle);
     d->m_handle = 0;
@@ -542,18 +1257,99 @@ void ResourceHandleManager::setupPOST(ResourceHandle* job, struct curl_slist** h
           curl_easy_setopt(d->m_handle, CURLOPT_POSTFIELDSIZE_LARGE, (int)size);
     }
 
+    if (d->m_networkJob) {
+        // The body is streamed from the network thread, so give it its own copy.
+        d->m_networkJob->formDataStream.setFormData(job->firstRequest().httpBody()->deepCopy());
+        curl_easy_setopt(d->m_handle, CURLOPT_READFUNCTION, networkReadCallback);
+        curl_easy_setopt(d->m_handle, CURLOPT_READDATA, d->m_networkJob);
+        return;
+    }
+
     curl_easy_setopt(d->m_handle, CURLOPT_READFUNCTION, readCallback);
     curl_easy_setopt(d->m_handle, CURLOPT_READDATA, job);
 }
 
+static bool isBlockingPriority(ResourceLoadPriority priority)
+{
+    // Style sheets, scripts, fonts and main resources hold up the first paint.
+    return priority >= ResourceLoadPriorityMedium;
+}
+
 void ResourceHandleManager::add(ResourceHandle* job)
 {
+    ResourceHandleInternal* d = job->getInternal();
+    d->m_blocksFirstPaint = isBlockingPriority(d->m_firstRequest.priority());
+
     // we can be called from within curl, so to avoid re-entrancy issues
     // schedule this job to be added the next time we enter curl download loop
     job->ref();
     m_resourceHandleList.append(job);
-    if (!m_downloadTimer.isActive())
-        m_downloadTimer.startOneShot(pollTimeSeconds);
+    scheduleJobs();
+}
+
+void ResourceHandleManager::scheduleJobs()
+{
+#if !USE(CURL_MULTI_SOCKET)
+    if (!m_usesNetworkThread) {
+        if (!m_downloadTimer.isActive())
+            m_downloadTimer.startOneShot(pollTimeSeconds);
+        return;
+    }
+#endif
+    if (!m_startJobsTimer.isActive())
+        m_startJobsTimer.startOneShot(0);
+}
+
+void ResourceHandleManager::setPriority(ResourceHandle* job, ResourceLoadPriority priority)
+{
+    ResourceHandleInternal* d = job->getInternal();
+    if (priority == ResourceLoadPriorityUnresolved || d->m_firstRequest.priority() == priority)
+        return;
+
+    // A queued job is simply picked up earlier or later by startScheduledJobs().
+    // Whether it holds back other loads was decided when it was added.
+    d->m_firstRequest.setPriority(priority);
+
+    if (!m_resourceHandleList.isEmpty())
+        scheduleJobs();
+}
+
+void ResourceHandleManager::addRunningJob(ResourceHandle* job)
+{
+    m_runningJobs++;
+    if (job->getInternal()->m_blocksFirstPaint)
+        m_runningBlockingJobs++;
+    else
+        m_runningLowPriorityJobs++;
+}
+
+void ResourceHandleManager::removeRunningJob(ResourceHandle* job)
+{
+    m_runningJobs--;
+    if (job->getInternal()->m_blocksFirstPaint)
+        m_runningBlockingJobs--;
+    else
+        m_runningLowPriorityJobs--;
+}
+
+size_t ResourceHandleManager::nextScheduledJob() const
+{
+    // Highest priority first, in the order they were added within one priority.
+    size_t next = notFound;
+    ResourceLoadPriority nextPriority = ResourceLoadPriorityUnresolved;
+    for (size_t i = 0; i < m_resourceHandleList.size(); ++i) {
+        ResourceLoadPriority priority = m_resourceHandleList[i]->getInternal()->m_firstRequest.priority();
+        if (priority > nextPriority) {
+            next = i;
+            nextPriority = priority;
+        }
+    }
+
+    // Keep most of the bandwidth for what the first paint is waiting on.
+    if (next != notFound && !m_resourceHandleList[next]->getInternal()->m_blocksFirstPaint
+        && m_runningBlockingJobs && m_runningLowPriorityJobs >= maxLowPriorityJobsWhileBlocking)
+        return notFound;
+    return next;
 }
 
 bool ResourceHandleManager::removeScheduledJob(ResourceHandle* job)
@@ -571,12 +1367,15 @@ bool ResourceHandleManager::removeScheduledJob(ResourceHandle* job)
 
 bool ResourceHandleManager::startScheduledJobs()
 {
-    // TODO: Create a separate stack of jobs for each domain.
+    // Per-host limits are left to curl, see maxConnectionsPerHost.
 
     bool started = false;
-    while (!m_resourceHandleList.isEmpty() && m_runningJobs < maxRunningJobs) {
-        ResourceHandle* job = m_resourceHandleList[0];
-        m_resourceHandleList.remove(0);
+    while (m_runningJobs < maxRunningJobs) {
+        size_t next = nextScheduledJob();
+        if (next == notFound)
+            break;
+        ResourceHandle* job = m_resourceHandleList[next];
+        m_resourceHandleList.remove(next);
         startJob(job);
         started = true;
     }
@@ -592,6 +1391,10 @@ void ResourceHandleManager::dispatchSynchronousJob(ResourceHandle* job)
         return;
     }
 
+    CurlCacheManager& cacheManager = CurlCacheManager::getInstance();
+    if (cacheManager.serveFromCache(job))
+        return;
+
     ResourceHandleInternal* handle = job->getInternal();
 
 #if LIBCURL_VERSION_NUM > 0x071200
@@ -605,11 +1408,14 @@ void ResourceHandleManager::dispatchSynchronousJob(ResourceHandle* job)
 
     // curl_easy_perform blocks until the transfert is finished.
     CURLcode ret =  curl_easy_perform(handle->m_handle);
+    recordConnectionStatistics(handle->m_handle);
 
     if (ret != 0) {
+        cacheManager.didFail(job);
         ResourceError error(String(handle->m_url), ret, String(handle->m_url), String(curl_easy_strerror(ret)));
         handle->client()->didFail(job, error);
-    }
+    } else
+        cacheManager.didFinishLoading(job);
 
     curl_easy_cleanup(handle->m_handle);
 }
@@ -623,9 +1429,35 @@ void ResourceHandleManager::startJob(ResourceHandle* job)
         return;
     }
 
+    if (CurlCacheManager::getInstance().serveFromCache(job)) {
+        // add() took a reference for a transfer that never happens.
+        job->deref();
+        return;
+    }
+
+    if (m_usesNetworkThread) {
+        ResourceHandleInternal* d = job->getInternal();
+        d->m_networkJob = new CurlNetworkJob(job);
+        initializeHandle(job);
+
+        CurlNetworkJob* networkJob = d->m_networkJob;
+        networkJob->handle = d->m_handle;
+        // initializeHandle() guesses the MIME type of local files.
+        networkJob->response.setMimeType(d->m_response.mimeType().crossThreadString());
+        curl_easy_setopt(d->m_handle, CURLOPT_PRIVATE, networkJob);
+        curl_easy_setopt(d->m_handle, CURLOPT_WRITEFUNCTION, networkWriteCallback);
+        curl_easy_setopt(d->m_handle, CURLOPT_WRITEDATA, networkJob);
+        curl_easy_setopt(d->m_handle, CURLOPT_HEADERFUNCTION, networkHeaderCallback);
+        curl_easy_setopt(d->m_handle, CURLOPT_WRITEHEADER, networkJob);
+
+        addRunningJob(job);
+        postNetworkCommand(AddJobCommand, networkJob);
+        return;
+    }
+
     initializeHandle(job);
 
-    m_runningJobs++;
+    addRunningJob(job);
     CURLMcode ret = curl_multi_add_handle(m_curlMultiHandle, job->getInternal()->m_handle);
     // don't call perform, because events must be async
     // timeout will occur and do curl_multi_perform
@@ -686,6 +1518,13 @@ void ResourceHandleManager::initializeHandle(ResourceHandle* job)
     curl_easy_setopt(d->m_handle, CURLOPT_HTTPAUTH, CURLAUTH_ANY);
     curl_easy_setopt(d->m_handle, CURLOPT_SHARE, m_curlShareHandle);
     curl_easy_setopt(d->m_handle, CURLOPT_DNS_CACHE_TIMEOUT, 60 * 5); // 5 minutes
+    curl_easy_setopt(d->m_handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    if (m_supportsHTTP2) {
+        // Negotiated through ALPN, so plain http:// stays on HTTP/1.1.
+        curl_easy_setopt(d->m_handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        // Wait for a connection that may multiplex rather than open another.
+        curl_easy_setopt(d->m_handle, CURLOPT_PIPEWAIT, 1L);
+    }
     // FIXME: Enable SSL verification when we have a way of shipping certs
     // and/or reporting SSL errors to the user.
     if (ignoreSSLErrors)
@@ -733,6 +1572,8 @@ void ResourceHandleManager::initializeHandle(ResourceHandle* job)
     else if ("HEAD" == job->firstRequest().httpMethod())
         curl_easy_setopt(d->m_handle, CURLOPT_NOBODY, TRUE);
 
+    CurlCacheManager::getInstance().willStartTransfer(job, &headers);
+
     if (headers) {
         curl_easy_setopt(d->m_handle, CURLOPT_HTTPHEADER, headers);
         d->m_customHeaders = headers;
@@ -756,9 +1597,26 @@ void ResourceHandleManager::cancel(ResourceHandle* job)
         return;
 
     ResourceHandleInternal* d = job->getInternal();
+    if (m_usesNetworkThread) {
+        if (d->m_networkJob && !d->m_cancelled)
+            postNetworkCommand(CancelJobCommand, d->m_networkJob);
+        d->m_cancelled = true;
+        return;
+    }
+
     d->m_cancelled = true;
+#if USE(CURL_MULTI_SOCKET)
+    // Nothing may call back into curl for an idle connection, so remove the
+    // handle ourselves once we are out of any curl callback.
+    if (d->m_handle && !m_cancelledJobs.contains(job)) {
+        m_cancelledJobs.append(job);
+        if (!m_startJobsTimer.isActive())
+            m_startJobsTimer.startOneShot(0);
+    }
+#else
     if (!m_downloadTimer.isActive())
         m_downloadTimer.startOneShot(pollTimeSeconds);
+#endif
 }
 
 } // namespace WebCore
@@ -30,6 +30,7 @@
 
 #include "Frame.h"
 #include "PlatformString.h"
+#include "ResourceLoadPriority.h"
 #include "Timer.h"
 #include "ResourceHandleClient.h"
 
@@ -39,11 +40,14 @@
 #endif
 
 #include <curl/curl.h>
+#include <wtf/Threading.h>
 #include <wtf/Vector.h>
 #include <wtf/text/CString.h>
 
 namespace WebCore {
 
+struct CurlNetworkJob;
+
 class ResourceHandleManager {
 public:
     enum ProxyType {
@@ -69,17 +73,102 @@ public:
                       const String& username = "",
                       const String& password = "");
 
+    // Moves the curl multi handle to a dedicated network thread. Responses and
+    // data are handed back to the main thread in one batch per job and per
+    // iteration of the network loop. Must be called before the first load.
+    void setUsesNetworkThread(bool);
+    bool usesNetworkThread() const { return m_usesNetworkThread; }
+    void setDefersLoading(ResourceHandle*, bool);
+
+    // Jobs start in order of their request's priority. While a blocking
+    // (medium or higher) job runs, only a couple of low priority ones may.
+    void setPriority(ResourceHandle*, ResourceLoadPriority);
+
+#if USE(CURL_MULTI_SOCKET)
+    // Socket readiness is posted here; it belongs to the main thread, so
+    // embedders without a full message loop have to pump it.
+    HWND socketWindowHandle() const { return m_socketWindowHandle; }
+#endif
+
+    // Counted as transfers complete, whichever thread runs them. A page whose
+    // subresources share connections shows few newConnections and
+    // tlsHandshakes relative to transfers.
+    struct ConnectionStatistics {
+        ConnectionStatistics()
+            : transfers(0)
+            , newConnections(0)
+            , reusedConnections(0)
+            , tlsHandshakes(0)
+            , http2Transfers(0)
+        {
+        }
+
+        unsigned transfers;
+        unsigned newConnections;
+        unsigned reusedConnections;
+        unsigned tlsHandshakes;
+        unsigned http2Transfers;
+    };
+    ConnectionStatistics connectionStatistics() const;
+    void resetConnectionStatistics();
+
+    // Called from the network thread's curl callbacks.
+    void queueNetworkRedirect(CurlNetworkJob*);
+    void queueNetworkResponse(CurlNetworkJob*);
+    void queueNetworkData(CurlNetworkJob*, const char* data, size_t length);
+
 private:
     ResourceHandleManager();
     ~ResourceHandleManager();
     void downloadTimerCallback(Timer<ResourceHandleManager>*);
+    void processMessages();
     void removeFromCurl(ResourceHandle*);
     bool removeScheduledJob(ResourceHandle*);
     void startJob(ResourceHandle*);
     bool startScheduledJobs();
+    size_t nextScheduledJob() const;
+    void scheduleJobs();
+    void addRunningJob(ResourceHandle*);
+    void removeRunningJob(ResourceHandle*);
 
     void initializeHandle(ResourceHandle*);
+    void recordConnectionStatistics(CURL*);
+    void startJobsTimerCallback(Timer<ResourceHandleManager>*);
+
+    enum NetworkCommandType {
+        AddJobCommand,
+        CancelJobCommand,
+        PauseJobCommand,
+        ResumeJobCommand
+    };
+    struct NetworkCommand {
+        NetworkCommandType type;
+        CurlNetworkJob* networkJob;
+    };
+    static void* networkThreadStart(void*);
+    static void deliverNetworkJob(void*);
+    void networkThreadLoop();
+    void postNetworkCommand(NetworkCommandType, CurlNetworkJob*);
+    void processNetworkCommands();
+    void processNetworkMessages();
+    void removeFromNetworkThread(CurlNetworkJob*);
+    void scheduleNetworkDelivery(CurlNetworkJob*);
+    void deliverPendingNetworkEvents(CurlNetworkJob*);
+    void finishNetworkJob(CurlNetworkJob*);
 
+#if USE(CURL_MULTI_SOCKET)
+    // curl drives the transfers through these: the socket callback tells us
+    // which sockets to watch and the timer callback when to wake up next.
+    static int curlSocketCallback(CURL*, curl_socket_t, int what, void* userp, void* socketp);
+    static int curlTimerCallback(CURLM*, long timeoutMS, void* userp);
+    static LRESULT CALLBACK socketWindowWndProc(HWND, UINT, WPARAM, LPARAM);
+    void initializeSocketWindow();
+    void socketAction(curl_socket_t, int eventMask);
+
+    Vector<ResourceHandle*> m_cancelledJobs;
+    HWND m_socketWindowHandle;
+#endif
+    Timer<ResourceHandleManager> m_startJobsTimer;
     Timer<ResourceHandleManager> m_downloadTimer;
     CURLM* m_curlMultiHandle;
     CURLSH* m_curlShareHandle;
@@ -88,9 +177,27 @@ private:
     Vector<ResourceHandle*> m_resourceHandleList;
     const CString m_certificatePath;
     int m_runningJobs;
+    int m_runningBlockingJobs;
+    int m_runningLowPriorityJobs;
     
     String m_proxy;
     ProxyType m_proxyType;
+
+    bool m_usesNetworkThread;
+    ThreadIdentifier m_networkThread;
+    // Main thread handle on the shared cookie store, used to mirror cookies
+    // into the wke cookie jar once the transfer's own handle is gone.
+    CURL* m_cookieHandle;
+
+    // Whether the linked libcurl was built with HTTP/2 support.
+    bool m_supportsHTTP2;
+    mutable Mutex m_statisticsMutex;
+    ConnectionStatistics m_connectionStatistics;
+    // Guards m_networkCommands and the pending events of every CurlNetworkJob.
+    Mutex m_networkMutex;
+    Vector<NetworkCommand> m_networkCommands;
+    // Only touched by the network thread.
+    Vector<CurlNetworkJob*> m_dirtyNetworkJobs;
 };
 
 }
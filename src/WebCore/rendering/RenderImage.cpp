@@ -204,6 +204,11 @@ void RenderImage::imageDimensionsChanged(bool imageSizeChanged, const IntRect* r
         }
     }
 
+    // With a fixed box, such as <img width height>, the image arriving causes
+    // no layout, so report the size the image is shown at here.
+    if (!selfNeedsLayout())
+        updateDisplayedSize();
+
     if (shouldRepaint) {
         IntRect repaintRect;
         if (rect) {
@@ -245,6 +250,20 @@ void RenderImage::notifyFinished(CachedResource* newImage)
 #endif
 }
 
+void RenderImage::layout()
+{
+    RenderReplaced::layout();
+    updateDisplayedSize();
+}
+
+void RenderImage::updateDisplayedSize()
+{
+    // The image need not be decoded larger than it is shown.
+    CachedImage* cachedImage = m_imageResource->cachedImage();
+    if (cachedImage && cachedImage->hasImage() && !cachedImage->errorOccurred())
+        cachedImage->image()->setDisplayedSize(IntSize(contentWidth(), contentHeight()));
+}
+
 void RenderImage::paintReplaced(PaintInfo& paintInfo, const LayoutPoint& paintOffset)
 {
     LayoutUnit cWidth = contentWidth();
@@ -256,6 +275,14 @@ void RenderImage::paintReplaced(PaintInfo& paintInfo, const LayoutPoint& paintOf
 
     GraphicsContext* context = paintInfo.context;
 
+    // We only get here once the image is inside the dirty rect, i.e. on
+    // screen; fetch it ahead of the images further down the page. The network
+    // layer still throttles it like an image behind style sheets and scripts.
+    if (CachedImage* cachedImage = m_imageResource->cachedImage()) {
+        if (cachedImage->isLoading())
+            cachedImage->setLoadPriority(ResourceLoadPriorityMedium);
+    }
+
     if (!m_imageResource->hasImage() || m_imageResource->errorOccurred()) {
         if (paintInfo.phase == PaintPhaseSelection)
             return;
@@ -61,6 +61,8 @@ protected:
     virtual void paintIntoRect(GraphicsContext*, const IntRect&);
     virtual void paint(PaintInfo&, const LayoutPoint&);
 
+    virtual void layout();
+
     bool isLogicalWidthSpecified() const;
     bool isLogicalHeightSpecified() const;
 
@@ -90,6 +92,7 @@ private:
 
     IntSize imageSizeForError(CachedImage*) const;
     void imageDimensionsChanged(bool imageSizeChanged, const IntRect* = 0);
+    void updateDisplayedSize();
 
     int calcAspectRatioLogicalWidth() const;
     int calcAspectRatioLogicalHeight() const;
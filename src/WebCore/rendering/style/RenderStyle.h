@@ -266,7 +266,10 @@ protected:
         unsigned char _pseudoBits : 7;
         unsigned char _unicodeBidi : 3; // EUnicodeBidi
         bool _isLink : 1;
-        // 53 bits
+        // Set when a declaration uses 'inherit', which can pull in properties
+        // that are not inherited by default.
+        bool _explicitInheritance : 1;
+        // 54 bits
     } noninherited_flags;
 
 // !END SYNC!
@@ -311,6 +314,7 @@ protected:
         noninherited_flags._pseudoBits = 0;
         noninherited_flags._unicodeBidi = initialUnicodeBidi();
         noninherited_flags._isLink = false;
+        noninherited_flags._explicitInheritance = false;
     }
 
 private:
@@ -328,6 +332,12 @@ public:
     ~RenderStyle();
 
     void inheritFrom(const RenderStyle* inheritParent);
+    void copyNonInheritedFrom(const RenderStyle*);
+
+    // These only check whether the data is shared, which is cheap but may report
+    // equal data held in different objects as different.
+    bool inheritedDataShared(const RenderStyle*) const;
+    bool nonInheritedDataShared(const RenderStyle*) const;
 
     PseudoId styleType() const { return static_cast<PseudoId>(noninherited_flags._styleType); }
     void setStyleType(PseudoId styleType) { noninherited_flags._styleType = styleType; }
@@ -346,6 +356,9 @@ public:
     void setAffectedByActiveRules(bool b) { noninherited_flags._affectedByActive = b; }
     void setAffectedByDragRules(bool b) { noninherited_flags._affectedByDrag = b; }
 
+    bool hasExplicitlyInheritedProperties() const { return noninherited_flags._explicitInheritance; }
+    void setHasExplicitlyInheritedProperties() { noninherited_flags._explicitInheritance = true; }
+
     bool operator==(const RenderStyle& other) const;
     bool operator!=(const RenderStyle& other) const { return !(*this == other); }
     bool isFloating() const { return noninherited_flags._floating != NoFloat; }
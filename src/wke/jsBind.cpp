@@ -9,6 +9,9 @@
 #include <JavaScriptCore/APICast.h>
 #include <JavaScriptCore/Completion.h>
 #include <JavaScriptCore/OpaqueJSString.h>
+#include <JavaScriptCore/Parser.h>
+#include <JavaScriptCore/SamplingProfiler.h>
+#include <WebCore/FileSystem.h>
 #include <WebCore/GCController.h>
 #include <WebCore/JSDOMWindowCustom.h>
 #include <WebCore/Page.h>
@@ -448,6 +451,53 @@ void wkeJSCollectGarbge()
     WebCore::gcController().garbageCollectNow();
 }
 
+void wkeJSGetParseStats(wkeJSParseStats* stats)
+{
+    const JSC::ParserStatistics& parserStats = WebCore::JSDOMWindowBase::commonJSGlobalData()->parser->statistics();
+    stats->programsParsed = parserStats.programsParsed;
+    stats->functionsParsed = parserStats.functionsParsed;
+    stats->functionBodiesSkipped = parserStats.functionBodiesSkipped;
+    stats->functionBodiesFromCache = parserStats.functionBodiesFromCache;
+    stats->skippedCharacters = (unsigned int)parserStats.skippedCharacters;
+    stats->lazyParseRetries = parserStats.lazyParseRetries;
+    stats->parseTime = parserStats.parseTime;
+}
+
+bool wkeJSStartSamplingProfiler(unsigned int intervalMs)
+{
+#if ENABLE(SAMPLING_PROFILER)
+    JSC::SamplingProfiler* profiler = WebCore::JSDOMWindowBase::commonJSGlobalData()->samplingProfiler.get();
+    return profiler->start(intervalMs ? intervalMs : JSC::SamplingProfiler::defaultIntervalInMilliseconds);
+#else
+    return false;
+#endif
+}
+
+bool wkeJSStopSamplingProfiler(const utf8* path)
+{
+#if ENABLE(SAMPLING_PROFILER)
+    JSC::SamplingProfiler* profiler = WebCore::JSDOMWindowBase::commonJSGlobalData()->samplingProfiler.get();
+    if (!profiler->isRunning())
+        return false;
+    profiler->stop();
+
+    bool written = true;
+    if (path) {
+        CString stacks = profiler->collapsedStacks();
+        WebCore::PlatformFileHandle file = WebCore::openFile(String::fromUTF8(path), WebCore::OpenForWrite);
+        if (WebCore::isHandleValid(file)) {
+            written = WebCore::writeToFile(file, stacks.data(), stacks.length()) == (int)stacks.length();
+            WebCore::closeFile(file);
+        } else
+            written = false;
+    }
+    profiler->clearSamples();
+    return written;
+#else
+    return false;
+#endif
+}
+
 
 void wkeJSAddRef(wkeJSState* es, wkeJSValue val)
 {
@@ -22,7 +22,10 @@ typedef struct
 enum wkeSettingMask 
 {
     WKE_SETTING_PROXY = 1,
-    WKE_SETTING_COOKIE_FILE_PATH = 1<<1
+    WKE_SETTING_COOKIE_FILE_PATH = 1<<1,
+    WKE_SETTING_NETWORK_THREAD = 1<<2,
+    WKE_SETTING_DISK_CACHE = 1<<3,
+    WKE_SETTING_IMAGE_DECODING_THREAD = 1<<4
 };
 namespace wke {
     class wkeSettings
@@ -31,12 +34,23 @@ namespace wke {
             wkeSettings(): proxy(nullptr),
                 cookieFilePath(nullptr),
                 mask(0),
-                pageScaleFactor(1.0f) {};
+                pageScaleFactor(1.0f),
+                networkThread(false),
+                diskCachePath(nullptr),
+                diskCacheSize(0),
+                imageDecodingThread(false) {};
         public:
             wkeProxy* proxy;
             char* cookieFilePath;
             unsigned int mask;
             float pageScaleFactor;
+            // run curl on its own thread, only honored before the first load
+            bool networkThread;
+            // persistent http cache, utf8 directory and size limit in bytes; 0 disables it
+            char* diskCachePath;
+            unsigned long long diskCacheSize;
+            // decode large images on background threads, painting them once they are ready
+            bool imageDecodingThread;
     };
     class wkeSettingsManeger {
         public:
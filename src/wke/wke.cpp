@@ -10,11 +10,16 @@
 #include <WebCore/WebCoreInstanceHandle.h>
 #include <WebCore/RenderThemeWin.h>
 #include <WebCore/ResourceHandleManager.h>
+#include <WebCore/CurlCacheManager.h>
+#include <WebCore/ImageSource.h>
+#include <WebCore/WidthCache.h>
+#include <WebCore/Document.h>
 #include <WebCore/Console.h>
 #include <WebCore/SecurityOrigin.h>
 #include <WebCore/DatabaseTracker.h>
 
 #include "wkePlatformStrategies.h"
+#include "wkeBlit.h"
 #include "icuwin.h"
 
 //cexer: 必须包含在后面，因为其中的 wke.h -> windows.h 会定义 max、min，导致 WebCore 内部的 max、min 出现错乱。
@@ -41,6 +46,7 @@ void wkeInitialize()
     JSC::initializeThreading();
     WTF::initializeMainThread();
     wke::PlatformStrategies::initialize();
+    wke::initializeBlitKernels();
 
     //cexer 解决不能加载本地图片的BUG。
     WebCore::SecurityOrigin::setLocalLoadPolicy(WebCore::SecurityOrigin::AllowLocalLoadsForAll);
@@ -86,6 +92,13 @@ void wkeConfigCookieFilePath(const char* path)
     WebCore::ResourceHandleManager::sharedInstance()->setCookieJarFileName(path);
 }
 
+void wkeConfigDiskCache(const char* path, unsigned long long size)
+{
+    WebCore::CurlCacheManager& cacheManager = WebCore::CurlCacheManager::getInstance();
+    cacheManager.setStorageSizeLimit(size);
+    cacheManager.setCacheDirectory(path ? String::fromUTF8(path) : String());
+}
+
 void wkeConfigure(wke::wkeSettings* settings)
 {
     if (settings->mask & WKE_SETTING_PROXY)
@@ -93,6 +106,15 @@ void wkeConfigure(wke::wkeSettings* settings)
 
     if (settings->mask & WKE_SETTING_COOKIE_FILE_PATH)
         wkeConfigCookieFilePath(settings->cookieFilePath);
+
+    if (settings->mask & WKE_SETTING_NETWORK_THREAD)
+        WebCore::ResourceHandleManager::sharedInstance()->setUsesNetworkThread(settings->networkThread);
+
+    if (settings->mask & WKE_SETTING_DISK_CACHE)
+        wkeConfigDiskCache(settings->diskCachePath, settings->diskCacheSize);
+
+    if (settings->mask & WKE_SETTING_IMAGE_DECODING_THREAD)
+        WebCore::ImageSource::setDecodesAsynchronously(settings->imageDecodingThread);
     wke::wkeSettingsManeger::SetInstance(settings);
 }
 
@@ -106,27 +128,41 @@ void wkeFinalize()
 {
     wkeUpdate();
 
+    WebCore::CurlCacheManager::getInstance().saveIndex();
     WebCore::iconDatabase().close();
     WebCore::PageGroup::closeLocalStorage();
 
     CoUninitialize();
 }
 
+static void dispatchWindowMessages(HWND hWnd)
+{
+    if (!hWnd)
+        return;
+
+    MSG msg;
+    while(PeekMessage(&msg, hWnd, 0, 0, PM_REMOVE))
+    {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+}
+
 void wkeUpdate()
 {
     static HWND hTimer = NULL;
     if (!hTimer)
         hTimer = FindWindow(L"TimerWindowClass", NULL);
 
-    if (hTimer)
-    {
-        MSG msg;
-        while(PeekMessage(&msg, hTimer, 0, 0, PM_REMOVE))
-        {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        }
-    }
+    dispatchWindowMessages(hTimer);
+
+    //network thread results are handed over through callOnMainThread.
+    dispatchWindowMessages(WTF::threadingWindowHandle());
+
+#if USE(CURL_MULTI_SOCKET)
+    //curl socket readiness is posted to a message-only window, see ResourceHandleManager.
+    dispatchWindowMessages(WebCore::ResourceHandleManager::sharedInstance()->socketWindowHandle());
+#endif
 }
 
 
@@ -159,6 +195,25 @@ void wkeSetFileSystem(FILE_OPEN pfn_open, FILE_CLOSE pfn_close, FILE_SIZE pfn_si
     // libcurl_set_file_system(pfn_open, pfn_close, pfn_size, pfn_read, pfn_seek);
 }
 
+void wkeGetImageDecodingTime(wkeImageDecodingTime* time)
+{
+    time->mainThread = WebCore::ImageSource::mainThreadDecodingTime();
+    time->decodingThreads = WebCore::ImageSource::decodingThreadTime();
+}
+
+void wkeGetWordWidthCacheStats(wkeWordWidthCacheStats* stats)
+{
+    stats->hits = WebCore::WidthCache::hitCount();
+    stats->misses = WebCore::WidthCache::missCount();
+}
+
+void wkeGetStyleRecalcStats(wkeStyleRecalcStats* stats)
+{
+    stats->recalcs = WebCore::Document::styleRecalcCount();
+    stats->restyledElements = WebCore::Document::restyledElementCount();
+    stats->lastRecalcRestyledElements = WebCore::Document::lastRecalcRestyledElementCount();
+}
+
 const char* wkeGetName(wkeWebView* webView)
 {
     return webView->name();
@@ -324,7 +379,12 @@ void wkeLayoutIfNeeded(wkeWebView* webView)
 
 void wkePaint(wkeWebView* webView,void* bits, int bufWid, int bufHei, int xDst, int yDst, int w, int h, int xSrc, int ySrc, bool bCopyAlpha)
 {
-    webView->paint(bits, bufWid,  bufHei,  xDst,  yDst,  w,  h,  xSrc,  ySrc, bCopyAlpha);
+    webView->paint(bits, bufWid,  bufHei,  xDst,  yDst,  w,  h,  xSrc,  ySrc, bCopyAlpha ? WKE_PAINT_COPY_ALPHA : 0);
+}
+
+void wkePaintEx(wkeWebView* webView, void* bits, int bufWid, int bufHei, int xDst, int yDst, int w, int h, int xSrc, int ySrc, unsigned int flags)
+{
+    webView->paint(bits, bufWid, bufHei, xDst, yDst, w, h, xSrc, ySrc, flags);
 }
 
 void wkePaint2(wkeWebView* webView, void* bits,int pitch)
@@ -774,6 +834,9 @@ bool wkeRepaintIfNeededAfterInterval(wkeWebView* webView)
 
 wkeWebView* wkeCreateWebView()
 {
+    // Everything a view touches belongs to the thread that called wkeInitialize.
+    ASSERT(WTF::isMainThread());
+
     wke::CWebView* webView = new wke::CWebView;
     s_webViews.append(webView);
     return webView;
@@ -816,28 +879,44 @@ bool wkeRepaintAllNeeded()
 
 int wkeRunMessageLoop(const bool *quit)
 {
+    if (!WTF::isMainThread())
+        return -1;
+
     MSG msg = { 0 };
     while (true)
     {
         if (quit && *quit)
             return 0;
 
-        //DWORD processStart = timeGetTime();
-        if (PeekMessageW(&msg, NULL, 0, 0, PM_REMOVE))
+        // Drain the queue before painting, loads post many messages per frame.
+        while (PeekMessageW(&msg, NULL, 0, 0, PM_REMOVE))
         {
             TranslateMessage(&msg);
             DispatchMessage(&msg);
 
             if (msg.message == WM_QUIT)
                 return (int)msg.wParam;
+
+            if (quit && *quit)
+                return 0;
         }
 
         wkeRepaintAllNeeded();
 
-        //DWORD processTime = timeGetTime() - processStart;
-        //if (processTime < 5)
-        //    Sleep(5 - processTime);
-        Sleep(1);
+        // Timers and network results all arrive as messages: the shared timer
+        // uses WM_TIMER or posts to its window, curl posts socket readiness and
+        // callOnMainThread posts to the threading window. Besides a dirty view's
+        // next repaint, only a quit flag set outside a message needs a wake up,
+        // so never sleep longer than the shortest Win32 timer interval.
+        DWORD timeout = USER_TIMER_MINIMUM;
+        for (size_t i = 0; i < s_webViews.size(); ++i)
+        {
+            DWORD delay = s_webViews[i]->timeUntilRepaint();
+            if (delay < timeout)
+                timeout = delay;
+        }
+
+        MsgWaitForMultipleObjectsEx(0, NULL, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
     }
 
     return 0;
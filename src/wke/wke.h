@@ -66,6 +66,15 @@ typedef enum
 
 } wkeKeyFlags;
 
+/* wkePaintEx flags, pixels are BGRA with premultiplied alpha by default */
+typedef enum
+{
+    WKE_PAINT_COPY_ALPHA = 0x01,
+    WKE_PAINT_UNPREMULTIPLY = 0x02,
+    WKE_PAINT_RGBA = 0x04,
+
+} wkePaintFlags;
+
 
 typedef enum
 {
@@ -128,6 +137,11 @@ extern "C"
 {
 #endif
 
+/*
+ *wke is single threaded: WebCore keeps its caches, timers, JavaScript heap and network manager in
+ *process-wide singletons. Call every function from the thread that called wkeInitialize, views
+ *must not be created on any other thread. Run one process per core to render pages in parallel.
+ */
 WKE_API void        WKE_CALL wkeInitialize();
 WKE_API void        WKE_CALL wkeInitializeEx(wke::wkeSettings* settings);
 WKE_API void        WKE_CALL wkeConfigure(wke::wkeSettings* settings);
@@ -144,6 +158,34 @@ typedef int       (WKE_CALL *FILE_READ) (void* handle, void* buffer, size_t size
 typedef int       (WKE_CALL *FILE_SEEK) (void* handle, int offset, int origin);
 WKE_API void        WKE_CALL wkeSetFileSystem(FILE_OPEN pfn_open, FILE_CLOSE pfn_close, FILE_SIZE pfn_size, FILE_READ pfn_read, FILE_SEEK pfn_seek);
 
+/*seconds spent in image decoders since startup, see WKE_SETTING_IMAGE_DECODING_THREAD*/
+typedef struct
+{
+    double mainThread;
+    double decodingThreads;
+} wkeImageDecodingTime;
+
+WKE_API void        WKE_CALL wkeGetImageDecodingTime(wkeImageDecodingTime* time);
+
+/*lookups in the word width cache since startup*/
+typedef struct
+{
+    unsigned int hits;
+    unsigned int misses;
+} wkeWordWidthCacheStats;
+
+WKE_API void        WKE_CALL wkeGetWordWidthCacheStats(wkeWordWidthCacheStats* stats);
+
+/*style recalcs since startup and the elements they gave a new style*/
+typedef struct
+{
+    unsigned int recalcs;
+    unsigned int restyledElements;
+    unsigned int lastRecalcRestyledElements;
+} wkeStyleRecalcStats;
+
+WKE_API void        WKE_CALL wkeGetStyleRecalcStats(wkeStyleRecalcStats* stats);
+
 
 WKE_API wkeWebView*  WKE_CALL wkeCreateWebView();
 WKE_API wkeWebView*  WKE_CALL wkeGetWebView(const char* name);
@@ -195,6 +237,7 @@ WKE_API void        WKE_CALL wkeAddDirtyArea(wkeWebView* webView, int x, int y,
 WKE_API void        WKE_CALL wkeLayoutIfNeeded(wkeWebView* webView);
 WKE_API void        WKE_CALL wkePaint(wkeWebView* webView, void* bits,int bufWid, int bufHei, int xDst, int yDst, int w, int h, int xSrc, int ySrc, bool bCopyAlpha);
 WKE_API void        WKE_CALL wkePaint2(wkeWebView* webView, void* bits,int pitch);
+WKE_API void        WKE_CALL wkePaintEx(wkeWebView* webView, void* bits,int bufWid, int bufHei, int xDst, int yDst, int w, int h, int xSrc, int ySrc, unsigned int flags);
 WKE_API bool        WKE_CALL wkeRepaintIfNeeded(wkeWebView* webView);
 WKE_API void*       WKE_CALL wkeGetViewDC(wkeWebView* webView);
 
@@ -202,6 +245,7 @@ WKE_API void        WKE_CALL wkeSetRepaintInterval(wkeWebView* webView, int ms);
 WKE_API int         WKE_CALL wkeGetRepaintInterval(wkeWebView* webView);
 WKE_API bool        WKE_CALL wkeRepaintIfNeededAfterInterval(wkeWebView* webView);
 WKE_API bool        WKE_CALL wkeRepaintAllNeeded();
+/*runs until WM_QUIT or *quit; a flag set while handling a message is seen at once, otherwise within 10ms*/
 WKE_API int         WKE_CALL wkeRunMessageLoop(const bool *quit);
 
 WKE_API bool        WKE_CALL wkeCanGoBack(wkeWebView* webView);
@@ -530,6 +574,24 @@ WKE_API void       WKE_CALL  wkeJSAddRef(wkeJSState* es, wkeJSValue v);
 WKE_API void       WKE_CALL  wkeJSReleaseRef(wkeJSState* es, wkeJSValue v);
 WKE_API void       WKE_CALL  wkeJSCollectGarbge(); 
 
+typedef struct
+{
+    unsigned int programsParsed;
+    unsigned int functionsParsed;           /*function bodies compiled on their first call*/
+    unsigned int functionBodiesSkipped;     /*brace-matched only, by the lazy parse of a large script*/
+    unsigned int functionBodiesFromCache;   /*skipped thanks to the parser's function cache*/
+    unsigned int skippedCharacters;
+    unsigned int lazyParseRetries;
+    double parseTime;                       /*seconds*/
+} wkeJSParseStats;
+
+WKE_API void       WKE_CALL  wkeJSGetParseStats(wkeJSParseStats* stats);
+
+/*samples the JavaScript stack of the calling (main) thread every intervalMs, 0 for 10ms*/
+WKE_API bool       WKE_CALL  wkeJSStartSamplingProfiler(unsigned int intervalMs);
+/*writes the samples as collapsed stacks for flame graph tools, then discards them; path may be NULL*/
+WKE_API bool       WKE_CALL  wkeJSStopSamplingProfiler(const utf8* path);
+
 // WKE_API void WKE_CALL wkeTest();
 
 
@@ -0,0 +1,304 @@
+
+#include "wkeBlit.h"
+
+#include <string.h>
+
+#if COMPILER(MSVC) && (CPU(X86) || CPU(X86_64))
+#define WKE_BLIT_SIMD 1
+#include <intrin.h>
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+namespace wke
+{
+    static void copyColorRowScalar(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        for (int i = 0; i < pixels; ++i)
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst += 4;
+            src += 4;
+        }
+    }
+
+    static inline unsigned char unpremultiplyComponent(unsigned char component, float scale)
+    {
+        float value = component * scale + 0.5f;
+        return value >= 255.0f ? 255 : static_cast<unsigned char>(value);
+    }
+
+    static void unpremultiplyRowScalar(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        for (int i = 0; i < pixels; ++i)
+        {
+            unsigned char alpha = src[3];
+            float scale = alpha ? 255.0f / alpha : 0.0f;
+            dst[0] = unpremultiplyComponent(src[0], scale);
+            dst[1] = unpremultiplyComponent(src[1], scale);
+            dst[2] = unpremultiplyComponent(src[2], scale);
+            dst[3] = alpha;
+            dst += 4;
+            src += 4;
+        }
+    }
+
+    static void swapRedBlueRowScalar(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        for (int i = 0; i < pixels; ++i)
+        {
+            unsigned char blue = src[0];
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = blue;
+            dst[3] = src[3];
+            dst += 4;
+            src += 4;
+        }
+    }
+
+#if WKE_BLIT_SIMD
+
+    // Every kernel handles whole vectors and leaves the tail to the scalar version.
+
+    static void copyColorRowSSE2(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+
+        int i = 0;
+        for (; i + 4 <= pixels; i += 4)
+        {
+            __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+            __m128i destination = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i * 4));
+            destination = _mm_or_si128(_mm_and_si128(source, colorMask), _mm_andnot_si128(colorMask, destination));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), destination);
+        }
+        copyColorRowScalar(dst + i * 4, src + i * 4, pixels - i);
+    }
+
+    static inline __m128i unpremultiplyPixelSSE2(__m128i pixel)
+    {
+        __m128 components = _mm_cvtepi32_ps(pixel);
+        __m128 alpha = _mm_shuffle_ps(components, components, _MM_SHUFFLE(3, 3, 3, 3));
+        __m128 scale = _mm_and_ps(_mm_div_ps(_mm_set1_ps(255.0f), alpha), _mm_cmpneq_ps(alpha, _mm_setzero_ps()));
+        return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(components, scale), _mm_set1_ps(0.5f)));
+    }
+
+    static void unpremultiplyRowSSE2(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+        int i = 0;
+        for (; i + 4 <= pixels; i += 4)
+        {
+            __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+
+            // Opaque pixels are already straight.
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(source, alphaMask), alphaMask)) == 0xFFFF)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), source);
+                continue;
+            }
+
+            __m128i low = _mm_unpacklo_epi8(source, zero);
+            __m128i high = _mm_unpackhi_epi8(source, zero);
+            __m128i pixel0 = unpremultiplyPixelSSE2(_mm_unpacklo_epi16(low, zero));
+            __m128i pixel1 = unpremultiplyPixelSSE2(_mm_unpackhi_epi16(low, zero));
+            __m128i pixel2 = unpremultiplyPixelSSE2(_mm_unpacklo_epi16(high, zero));
+            __m128i pixel3 = unpremultiplyPixelSSE2(_mm_unpackhi_epi16(high, zero));
+            __m128i result = _mm_packus_epi16(_mm_packs_epi32(pixel0, pixel1), _mm_packs_epi32(pixel2, pixel3));
+
+            result = _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(source, alphaMask));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), result);
+        }
+        unpremultiplyRowScalar(dst + i * 4, src + i * 4, pixels - i);
+    }
+
+    static void swapRedBlueRowSSE2(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        const __m128i greenAlphaMask = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+        const __m128i lowByteMask = _mm_set1_epi32(0x000000FF);
+
+        int i = 0;
+        for (; i + 4 <= pixels; i += 4)
+        {
+            __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+            __m128i red = _mm_and_si128(_mm_srli_epi32(source, 16), lowByteMask);
+            __m128i blue = _mm_slli_epi32(_mm_and_si128(source, lowByteMask), 16);
+            __m128i result = _mm_or_si128(_mm_and_si128(source, greenAlphaMask), _mm_or_si128(red, blue));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), result);
+        }
+        swapRedBlueRowScalar(dst + i * 4, src + i * 4, pixels - i);
+    }
+
+    // The AVX2 kernels clear the upper halves on exit to avoid SSE transition stalls.
+
+    static void copyColorRowAVX2(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        const __m256i colorMask = _mm256_set1_epi32(0x00FFFFFF);
+
+        int i = 0;
+        for (; i + 8 <= pixels; i += 8)
+        {
+            __m256i source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+            __m256i destination = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i * 4));
+            destination = _mm256_or_si256(_mm256_and_si256(source, colorMask), _mm256_andnot_si256(colorMask, destination));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), destination);
+        }
+        _mm256_zeroupper();
+        copyColorRowScalar(dst + i * 4, src + i * 4, pixels - i);
+    }
+
+    static inline __m256i unpremultiplyPixelsAVX2(__m256i pixels)
+    {
+        __m256 components = _mm256_cvtepi32_ps(pixels);
+        __m256 alpha = _mm256_permute_ps(components, _MM_SHUFFLE(3, 3, 3, 3));
+        __m256 scale = _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(255.0f), alpha), _mm256_cmp_ps(alpha, _mm256_setzero_ps(), _CMP_NEQ_OQ));
+        return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(components, scale), _mm256_set1_ps(0.5f)));
+    }
+
+    static void unpremultiplyRowAVX2(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+
+        // Unpacking and packing both work within 128-bit lanes, so the pixel order comes out unchanged.
+        int i = 0;
+        for (; i + 8 <= pixels; i += 8)
+        {
+            __m256i source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(source, alphaMask), alphaMask)) == -1)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), source);
+                continue;
+            }
+
+            __m256i low = _mm256_unpacklo_epi8(source, zero);
+            __m256i high = _mm256_unpackhi_epi8(source, zero);
+            __m256i pixels0 = unpremultiplyPixelsAVX2(_mm256_unpacklo_epi16(low, zero));
+            __m256i pixels1 = unpremultiplyPixelsAVX2(_mm256_unpackhi_epi16(low, zero));
+            __m256i pixels2 = unpremultiplyPixelsAVX2(_mm256_unpacklo_epi16(high, zero));
+            __m256i pixels3 = unpremultiplyPixelsAVX2(_mm256_unpackhi_epi16(high, zero));
+            __m256i result = _mm256_packus_epi16(_mm256_packs_epi32(pixels0, pixels1), _mm256_packs_epi32(pixels2, pixels3));
+
+            result = _mm256_or_si256(_mm256_andnot_si256(alphaMask, result), _mm256_and_si256(source, alphaMask));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), result);
+        }
+        _mm256_zeroupper();
+        unpremultiplyRowScalar(dst + i * 4, src + i * 4, pixels - i);
+    }
+
+    static void swapRedBlueRowAVX2(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        const __m256i greenAlphaMask = _mm256_set1_epi32(static_cast<int>(0xFF00FF00));
+        const __m256i lowByteMask = _mm256_set1_epi32(0x000000FF);
+
+        int i = 0;
+        for (; i + 8 <= pixels; i += 8)
+        {
+            __m256i source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+            __m256i red = _mm256_and_si256(_mm256_srli_epi32(source, 16), lowByteMask);
+            __m256i blue = _mm256_slli_epi32(_mm256_and_si256(source, lowByteMask), 16);
+            __m256i result = _mm256_or_si256(_mm256_and_si256(source, greenAlphaMask), _mm256_or_si256(red, blue));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), result);
+        }
+        _mm256_zeroupper();
+        swapRedBlueRowScalar(dst + i * 4, src + i * 4, pixels - i);
+    }
+
+#endif // WKE_BLIT_SIMD
+
+    static BlitKernelType detectBlitKernelType()
+    {
+#if WKE_BLIT_SIMD
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        bool hasSSE2 = (info[3] & (1 << 26)) != 0;
+        bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+        bool hasAVX = (info[2] & (1 << 28)) != 0;
+
+        // AVX2 also needs the OS to save the YMM registers.
+        if (maxLeaf >= 7 && hasOSXSave && hasAVX && (_xgetbv(0) & 6) == 6)
+        {
+            __cpuidex(info, 7, 0);
+            if (info[1] & (1 << 5))
+                return BLIT_KERNEL_AVX2;
+        }
+
+        if (hasSSE2)
+            return BLIT_KERNEL_SSE2;
+#endif
+        return BLIT_KERNEL_SCALAR;
+    }
+
+    typedef void (*BlitRowFunction)(unsigned char* dst, const unsigned char* src, int pixels);
+
+    struct BlitKernels
+    {
+        BlitKernelType type;
+        BlitRowFunction copyColorRow;
+        BlitRowFunction unpremultiplyRow;
+        BlitRowFunction swapRedBlueRow;
+    };
+
+    // Constant-initialized, so the scalar kernels work before initializeBlitKernels().
+    static BlitKernels s_kernels = { BLIT_KERNEL_SCALAR, copyColorRowScalar, unpremultiplyRowScalar, swapRedBlueRowScalar };
+
+    BlitKernelType initializeBlitKernels(BlitKernelType widest)
+    {
+        BlitKernels kernels = { BLIT_KERNEL_SCALAR, copyColorRowScalar, unpremultiplyRowScalar, swapRedBlueRowScalar };
+        BlitKernelType type = detectBlitKernelType();
+        if (type > widest)
+            type = widest;
+#if WKE_BLIT_SIMD
+        if (type == BLIT_KERNEL_AVX2)
+        {
+            kernels.type = BLIT_KERNEL_AVX2;
+            kernels.copyColorRow = copyColorRowAVX2;
+            kernels.unpremultiplyRow = unpremultiplyRowAVX2;
+            kernels.swapRedBlueRow = swapRedBlueRowAVX2;
+        }
+        else if (type == BLIT_KERNEL_SSE2)
+        {
+            kernels.type = BLIT_KERNEL_SSE2;
+            kernels.copyColorRow = copyColorRowSSE2;
+            kernels.unpremultiplyRow = unpremultiplyRowSSE2;
+            kernels.swapRedBlueRow = swapRedBlueRowSSE2;
+        }
+#endif
+        s_kernels = kernels;
+        return s_kernels.type;
+    }
+
+    void blitCopyRow(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        memcpy(dst, src, pixels * 4);
+    }
+
+    void blitCopyColorRow(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        s_kernels.copyColorRow(dst, src, pixels);
+    }
+
+    void blitUnpremultiplyRow(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        s_kernels.unpremultiplyRow(dst, src, pixels);
+    }
+
+    void blitSwapRedBlueRow(unsigned char* dst, const unsigned char* src, int pixels)
+    {
+        s_kernels.swapRedBlueRow(dst, src, pixels);
+    }
+
+    BlitKernelType blitKernelType()
+    {
+        return s_kernels.type;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef WKE_BLIT_H
+#define WKE_BLIT_H
+
+//////////////////////////////////////////////////////////////////////////
+
+// Row kernels for copying the 32-bit BGRA pixels of a view into embedder
+// buffers. wkeInitialize() calls initializeBlitKernels() to pick the widest
+// implementation the CPU supports (AVX2, SSE2 or plain C); until then the
+// plain C kernels are used.
+
+namespace wke
+{
+    enum BlitKernelType
+    {
+        BLIT_KERNEL_SCALAR,
+        BLIT_KERNEL_SSE2,
+        BLIT_KERNEL_AVX2,
+    };
+
+    // Copies color and alpha.
+    void blitCopyRow(unsigned char* dst, const unsigned char* src, int pixels);
+
+    // Copies color only, the alpha bytes already in dst are kept.
+    void blitCopyColorRow(unsigned char* dst, const unsigned char* src, int pixels);
+
+    // Converts premultiplied pixels to straight alpha. Transparent pixels become 0.
+    void blitUnpremultiplyRow(unsigned char* dst, const unsigned char* src, int pixels);
+
+    // Swaps red and blue, BGRA to RGBA and back. dst may be src.
+    void blitSwapRedBlueRow(unsigned char* dst, const unsigned char* src, int pixels);
+
+    BlitKernelType blitKernelType();
+
+    // Selects the kernels, capped at widest, and returns the type in use. Not
+    // thread-safe: call it before any view paints or decodes.
+    BlitKernelType initializeBlitKernels(BlitKernelType widest = BLIT_KERNEL_AVX2);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif//WKE_BLIT_H
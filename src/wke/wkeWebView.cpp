@@ -9,9 +9,12 @@
 #include "icuwin.h"
 
 //cexer: 必须包含在后面，因为其中的 wke.h -> windows.h 会定义 max、min，导致 WebCore 内部的 max、min 出现错乱。
+#include "wkeBlit.h"
 #include "wkeDebug.h"
 #include "wkeWebView.h"
 
+#include <cairo.h>
+#include <limits.h>
 #include <shlwapi.h>
 #pragma comment(lib, "shlwapi.lib")
 
@@ -28,6 +31,7 @@ namespace wke
         , m_width(0)
         , m_height(0)
         , m_graphicsContext(NULL)
+        , m_pixels(NULL)
         , m_awake(true)
         , m_title("")
         , m_cookie("")
@@ -37,7 +41,6 @@ namespace wke
     {
         _initHandler();
         _initPage();
-        _initMemoryDC();
     }
 
     CWebView::~CWebView()
@@ -86,7 +89,8 @@ namespace wke
             return;
 
         m_transparent = transparent;
-        m_dirtyArea = WebCore::IntRect(0, 0, m_width, m_height);
+        m_dirtyRects.clear();
+        m_dirtyRects.append(WebCore::IntRect(0, 0, m_width, m_height));
         setDirty(true);
 
         if (m_graphicsContext)
@@ -421,7 +425,8 @@ namespace wke
             m_width = w;
             m_height = h;
 
-            m_dirtyArea = WebCore::IntRect(0, 0, w, h);
+            m_dirtyRects.clear();
+            m_dirtyRects.append(WebCore::IntRect(0, 0, w, h));
             setDirty(true);
 
             if (m_graphicsContext)
@@ -466,11 +471,76 @@ namespace wke
     {
         if (w > 0 && h > 0)
         {
-            m_dirtyArea.unite(WebCore::IntRect(x, y, w, h));
+            WebCore::IntRect rect(x, y, w, h);
+            rect.intersect(WebCore::IntRect(0, 0, m_width, m_height));
+            if (!rect.isEmpty())
+                _addDirtyRect(rect);
             m_dirty = true;
         }
     }
 
+    // Beyond this many rects the cost of painting each one separately outweighs
+    // the area saved, so the cheapest pairs get merged.
+    static const size_t maxDirtyRects = 8;
+
+    void CWebView::_addDirtyRect(const WebCore::IntRect& dirtyRect)
+    {
+        WebCore::IntRect rect = dirtyRect;
+
+        // Keep the list disjoint. A merged rect may overlap rects already
+        // checked, so start over after every merge.
+        for (size_t i = 0; i < m_dirtyRects.size(); )
+        {
+            if (m_dirtyRects[i].contains(rect))
+                return;
+
+            if (m_dirtyRects[i].intersects(rect))
+            {
+                rect.unite(m_dirtyRects[i]);
+                m_dirtyRects.remove(i);
+                i = 0;
+                continue;
+            }
+            ++i;
+        }
+
+        m_dirtyRects.append(rect);
+        if (m_dirtyRects.size() > maxDirtyRects)
+            _mergeDirtyRects();
+    }
+
+    static int rectArea(const WebCore::IntRect& rect)
+    {
+        return rect.width() * rect.height();
+    }
+
+    void CWebView::_mergeDirtyRects()
+    {
+        // Merge the pair whose bounding rect adds the least undamaged area.
+        size_t first = 0;
+        size_t second = 1;
+        int leastWaste = INT_MAX;
+        for (size_t i = 0; i < m_dirtyRects.size(); ++i)
+        {
+            for (size_t j = i + 1; j < m_dirtyRects.size(); ++j)
+            {
+                WebCore::IntRect merged = WebCore::unionRect(m_dirtyRects[i], m_dirtyRects[j]);
+                int waste = rectArea(merged) - rectArea(m_dirtyRects[i]) - rectArea(m_dirtyRects[j]);
+                if (waste < leastWaste)
+                {
+                    leastWaste = waste;
+                    first = i;
+                    second = j;
+                }
+            }
+        }
+
+        WebCore::IntRect merged = WebCore::unionRect(m_dirtyRects[first], m_dirtyRects[second]);
+        m_dirtyRects.remove(second);
+        m_dirtyRects.remove(first);
+        _addDirtyRect(merged);
+    }
+
     void CWebView::layoutIfNeeded()
     {
         m_mainFrame->view()->updateLayoutAndStyleIfNeededRecursive();
@@ -484,42 +554,91 @@ namespace wke
         layoutIfNeeded();
 
         if (m_graphicsContext == NULL)
+            _createBackingStore();
+
+        // Painting may invalidate again, work on a copy of the list. Anything
+        // invalidated from here on sets m_dirty again and waits for the next call.
+        Vector<WebCore::IntRect> dirtyRects;
+        dirtyRects.swap(m_dirtyRects);
+        m_dirty = false;
+
+        for (size_t i = 0; i < dirtyRects.size(); ++i)
         {
-            WebCore::BitmapInfo bmp = WebCore::BitmapInfo::createBottomUp(WebCore::IntSize(m_width, m_height));
-            HBITMAP hbmp = ::CreateDIBSection(0, &bmp, DIB_RGB_COLORS, &m_pixels, NULL, 0);
-            ::SelectObject(m_hdc.get(), hbmp);
-            m_hbitmap = adoptPtr(hbmp);
+            const WebCore::IntRect& dirtyRect = dirtyRects[i];
 
-            m_graphicsContext = new WebCore::GraphicsContext(m_hdc.get(), m_transparent);
-        }
+            m_graphicsContext->save();
 
-        m_graphicsContext->save();
+            if (m_transparent)
+                m_graphicsContext->clearRect(dirtyRect);
 
-        if (m_transparent)
-            m_graphicsContext->clearRect(m_dirtyArea);
+            m_graphicsContext->clip(dirtyRect);
 
-        m_graphicsContext->clip(m_dirtyArea);
+            m_mainFrame->view()->paint(m_graphicsContext, dirtyRect);
+
+            m_graphicsContext->restore();
+        }
 
-        m_mainFrame->view()->paint(m_graphicsContext, m_dirtyArea);
+        if (m_surface)
+            cairo_surface_flush(m_surface.get());
 
-        m_graphicsContext->restore();
         ChromeClient* client = (ChromeClient*)page()->chrome()->client();
         client->paintPopupMenu(m_pixels,  m_width*4);
 
         if(m_handler.paintUpdatedCallback)
         {
-            WebCore::IntPoint pt = m_dirtyArea.location();
-            WebCore::IntSize sz = m_dirtyArea.size();
-            m_handler.paintUpdatedCallback(this, m_handler.paintUpdatedCallbackParam, m_hdc.get(),pt.x(),pt.y(),sz.width(),sz.height());	
+            for (size_t i = 0; i < dirtyRects.size(); ++i)
+            {
+                const WebCore::IntRect& dirtyRect = dirtyRects[i];
+                m_handler.paintUpdatedCallback(this, m_handler.paintUpdatedCallbackParam, m_hdc.get(), dirtyRect.x(), dirtyRect.y(), dirtyRect.width(), dirtyRect.height());
+            }
         }
-        m_dirtyArea = WebCore::IntRect();
-        m_dirty = false;
 
         return true;
     }
 
+    void CWebView::_createBackingStore()
+    {
+        if (m_hdc)
+        {
+            WebCore::BitmapInfo bmp = WebCore::BitmapInfo::createBottomUp(WebCore::IntSize(m_width, m_height));
+            HBITMAP hbmp = ::CreateDIBSection(0, &bmp, DIB_RGB_COLORS, &m_pixels, NULL, 0);
+            ::SelectObject(m_hdc.get(), hbmp);
+            m_hbitmap = adoptPtr(hbmp);
+            m_surface = 0;
+
+            m_graphicsContext = new WebCore::GraphicsContext(m_hdc.get(), m_transparent);
+            return;
+        }
+
+        // No one needs a DC, paint straight into an image surface the view owns.
+        m_surface = adoptRef(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, m_width, m_height));
+        ASSERT(cairo_image_surface_get_stride(m_surface.get()) == m_width * 4);
+        m_pixels = cairo_image_surface_get_data(m_surface.get());
+
+        cairo_t* cr = cairo_create(m_surface.get());
+        m_graphicsContext = new WebCore::GraphicsContext(cr);
+        cairo_destroy(cr);
+    }
+
     HDC CWebView::viewDC()
     {
+        if (!m_hdc)
+        {
+            _initMemoryDC();
+
+            // Move what was painted so far over to a DIB section the DC can blit from.
+            if (m_graphicsContext)
+            {
+                RefPtr<cairo_surface_t> surface = m_surface;
+                delete m_graphicsContext;
+                m_graphicsContext = NULL;
+
+                _createBackingStore();
+                if (surface && m_pixels)
+                    memcpy(m_pixels, cairo_image_surface_get_data(surface.get()), m_width * m_height * 4);
+            }
+        }
+
         return m_hdc.get();
     }
 
@@ -545,7 +664,7 @@ namespace wke
 
     }
 
-    void CWebView::paint(void* bits, int bufWid, int bufHei, int xDst, int yDst, int w, int h, int xSrc, int ySrc, bool bCopyAlpha)
+    void CWebView::paint(void* bits, int bufWid, int bufHei, int xDst, int yDst, int w, int h, int xSrc, int ySrc, unsigned int flags)
     {
         if(m_dirty) repaintIfNeeded();
 
@@ -556,6 +675,9 @@ namespace wke
         if(xDst + w > bufWid) w =bufWid - xDst;
         if(yDst + h > bufHei) h = bufHei - yDst;
 
+        if(w <= 0 || h <= 0)
+            return;
+
         int pitchDst = bufWid*4;
         int pitchSrc = m_width*4;
 
@@ -564,27 +686,20 @@ namespace wke
         src += pitchSrc*ySrc + xSrc*4;
         dst += yDst*pitchDst + xDst*4;
 
-        if(bCopyAlpha)
-        {
-            for(int j = 0; j< h; j++)
-            {
-                memcpy(dst,src,w*4);
-                dst += pitchDst;
-                src += pitchSrc;
-            }
-        }else
+        for(int j = 0; j< h; j++)
         {
-            for(int j = 0; j< h; j++)
-            {
-                for(int i=0;i<w;i++)
-                {
-                    memcpy(dst,src,3);
-                    dst += 4;
-                    src += 4;
-                }
-                dst += (bufWid - w)*4;
-                src += (m_width - w)*4;
-            }
+            if(flags & WKE_PAINT_UNPREMULTIPLY)
+                blitUnpremultiplyRow(dst, src, w);
+            else if(flags & WKE_PAINT_COPY_ALPHA)
+                blitCopyRow(dst, src, w);
+            else
+                blitCopyColorRow(dst, src, w);
+
+            if(flags & WKE_PAINT_RGBA)
+                blitSwapRedBlueRow(dst, dst, w);
+
+            dst += pitchDst;
+            src += pitchSrc;
         }
     }
 
@@ -1179,6 +1294,10 @@ namespace wke
     {
         m_handler.paintUpdatedCallback = callback;
         m_handler.paintUpdatedCallbackParam = callbackParam;
+
+        // The callback is handed the view DC.
+        if (callback)
+            viewDC();
     }
 
     void CWebView::onAlertBox(wkeAlertBoxCallback callback, void* callbackParam)
@@ -1511,5 +1630,14 @@ namespace wke
         return true;
     }
 
+    DWORD CWebView::timeUntilRepaint() const
+    {
+        if (!m_dirty)
+            return INFINITE;
+
+        DWORD elapsed = timeGetTime() - m_lastPaintTimeTick;
+        return elapsed < m_paintInterval ? m_paintInterval - elapsed : 0;
+    }
+
 };//namespace wke
 
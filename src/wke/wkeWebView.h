@@ -16,6 +16,7 @@
 #include <WebCore/HTMLFormElement.h>
 #include <WebCore/FrameView.h>
 #include <WebCore/BitmapInfo.h>
+#include <WebCore/RefPtrCairo.h>
 #include <WebCore/Settings.h>
 #include <WebCore/PlatformWheelEvent.h>
 #include <WebCore/PlatformKeyboardEvent.h>
@@ -135,7 +136,7 @@ public:
 
     void layoutIfNeeded();
     void paint(void* bits, int pitch);
-    void paint(void* bits, int bufWid, int bufHei, int xDst, int yDst, int w, int h, int xSrc, int ySrc, bool fKeepAlpha);
+    void paint(void* bits, int bufWid, int bufHei, int xDst, int yDst, int w, int h, int xSrc, int ySrc, unsigned int flags);
 	bool repaintIfNeeded();
     HDC viewDC();
     
@@ -212,11 +213,16 @@ public:
     void setRepaintInterval(int ms);
     int repaintInterval() const;
     bool repaintIfNeededAfterInterval();
+    // Milliseconds until repaintIfNeededAfterInterval() would paint, INFINITE if nothing is dirty.
+    DWORD timeUntilRepaint() const;
 
 protected:
     void _initHandler();
     void _initPage();
     void _initMemoryDC();
+    void _createBackingStore();
+    void _addDirtyRect(const WebCore::IntRect& rect);
+    void _mergeDirtyRects();
 
     //按理这些接口应该使用CWebView来实现的，可以把它们想像成一个类，因此设置为友员符合情理。
     friend class ToolTip;
@@ -240,11 +246,15 @@ protected:
     int m_height;
 
     bool m_dirty;
-    WebCore::IntRect m_dirtyArea;
+    // Disjoint damaged rects, painted and reported one by one.
+    Vector<WebCore::IntRect> m_dirtyRects;
 
     WebCore::GraphicsContext* m_graphicsContext;
+    // Created on demand, only views that hand out a DC paint into a DIB section.
     OwnPtr<HDC> m_hdc;
     OwnPtr<HBITMAP> m_hbitmap;
+    // Backing store of views without a DC.
+    RefPtr<cairo_surface_t> m_surface;
     void* m_pixels;
 
     bool m_awake;
@@ -208,7 +208,7 @@ void CWebWindow::_paintDC(HDC hdc, HDC sourceDC)
     //ReleaseDC(m_hwnd, hdc);
 }
 
-void CWebWindow::_paintLayeredDC(HDC hdc, HDC sourceDC)
+void CWebWindow::_paintLayeredDC(HDC hdc, HDC sourceDC, const RECT& dirtyRect)
 {
     RECT rectDest;
     GetWindowRect(m_hwnd, &rectDest);
@@ -228,7 +228,26 @@ void CWebWindow::_paintLayeredDC(HDC hdc, HDC sourceDC)
     blend.BlendOp = AC_SRC_OVER;
     blend.SourceConstantAlpha = 255;
     blend.AlphaFormat = AC_SRC_ALPHA;
-    UpdateLayeredWindow(m_hwnd, hdc, &pointDest, &sizeDest, sourceDC, &pointSource, RGB(0,0,0), &blend, ULW_ALPHA);
+
+    // The view reports every dirty rect of a frame separately; only push the
+    // one that changed instead of the whole window each time.
+    UPDATELAYEREDWINDOWINFO info = { 0 };
+    info.cbSize = sizeof(info);
+    info.hdcDst = hdc;
+    info.pptDst = &pointDest;
+    info.psize = &sizeDest;
+    info.hdcSrc = sourceDC;
+    info.pptSrc = &pointSource;
+    info.crKey = RGB(0,0,0);
+    info.pblend = &blend;
+    info.dwFlags = ULW_ALPHA;
+    info.prcDirty = &dirtyRect;
+    if (!UpdateLayeredWindowIndirect(m_hwnd, &info))
+    {
+        // A partial update is refused while the window changes size.
+        info.prcDirty = NULL;
+        UpdateLayeredWindowIndirect(m_hwnd, &info);
+    }
 
     //SelectObject(hdcMemory, (HGDIOBJ)hbmpOld);
     //DeleteObject((HGDIOBJ)hbmpMemory);
@@ -644,13 +663,16 @@ void CWebWindow::_onPaintUpdated(const HDC sourceDC, int x, int y, int cx, int c
 {
     if (WS_EX_LAYERED == (WS_EX_LAYERED & GetWindowLong(m_hwnd, GWL_EXSTYLE)))
     {
+        RECT dirtyRect = { x, y, x + cx, y + cy };
         HDC hdc = GetDC(NULL);
-        _paintLayeredDC(hdc, sourceDC);
+        _paintLayeredDC(hdc, sourceDC, dirtyRect);
         ReleaseDC(NULL, hdc);
     }
     else
     {
+        // Only copy the rect that was repainted.
         HDC hdc =GetDC(m_hwnd);
+        IntersectClipRect(hdc, x, y, x + cx, y + cy);
         _paintDC(hdc, sourceDC);
         ReleaseDC(m_hwnd, hdc);
     }
@@ -45,7 +45,7 @@ protected:
     void _destroyWindow();
     void _initCallbacks();
     void _paintDC(HDC hdc, HDC sourceDC);
-    void _paintLayeredDC(HDC hdc, HDC sourceDC);
+    void _paintLayeredDC(HDC hdc, HDC sourceDC, const RECT& dirtyRect);
 
     static LRESULT CALLBACK _staticWindowProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
     LRESULT _windowProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
@@ -0,0 +1,136 @@
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wkeBlit.h"
+
+// Measures the wkeBlit row kernels on a 4K frame and prints GB/s of source
+// pixels for every kernel type the CPU supports.
+//
+//   wkeBlitBench [frames]
+
+static const int kWidth = 3840;
+static const int kHeight = 2160;
+
+typedef void (*RowFunction)(unsigned char* dst, const unsigned char* src, int pixels);
+
+static const char* kernelName(wke::BlitKernelType type)
+{
+    switch (type)
+    {
+    case wke::BLIT_KERNEL_AVX2: return "AVX2";
+    case wke::BLIT_KERNEL_SSE2: return "SSE2";
+    default: return "scalar";
+    }
+}
+
+static double runFrames(RowFunction row, unsigned char* dst, const unsigned char* src, int frames)
+{
+    LARGE_INTEGER freq, start, end;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+
+    const int pitch = kWidth * 4;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        for (int y = 0; y < kHeight; ++y)
+            row(dst + y * pitch, src + y * pitch, kWidth);
+    }
+
+    QueryPerformanceCounter(&end);
+    double seconds = (double)(end.QuadPart - start.QuadPart) / (double)freq.QuadPart;
+    double bytes = (double)pitch * kHeight * frames;
+    return bytes / seconds / 1e9;
+}
+
+static void fillPremultiplied(unsigned char* pixels, int count)
+{
+    srand(1);
+    for (int i = 0; i < count; ++i)
+    {
+        unsigned char alpha = (unsigned char)(rand() & 0xff);
+        pixels[i * 4 + 0] = (unsigned char)(rand() % (alpha + 1));
+        pixels[i * 4 + 1] = (unsigned char)(rand() % (alpha + 1));
+        pixels[i * 4 + 2] = (unsigned char)(rand() % (alpha + 1));
+        pixels[i * 4 + 3] = alpha;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 100;
+    if (frames <= 0)
+        frames = 100;
+
+    const size_t frameBytes = (size_t)kWidth * kHeight * 4;
+    unsigned char* src = (unsigned char*)_aligned_malloc(frameBytes, 32);
+    unsigned char* dst = (unsigned char*)_aligned_malloc(frameBytes, 32);
+    unsigned char* expected = (unsigned char*)_aligned_malloc(frameBytes, 32);
+    if (!src || !dst || !expected)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    fillPremultiplied(src, kWidth * kHeight);
+    memset(dst, 0, frameBytes);
+
+    static const struct {
+        const char* name;
+        RowFunction row;
+    } tests[] = {
+        { "copy", wke::blitCopyRow },
+        { "copyColor", wke::blitCopyColorRow },
+        { "unpremultiply", wke::blitUnpremultiplyRow },
+        { "swapRedBlue", wke::blitSwapRedBlueRow },
+    };
+
+    printf("%dx%d, %d frames, GB/s of source pixels\n", kWidth, kHeight, frames);
+    printf("%-14s", "");
+    for (int type = wke::BLIT_KERNEL_SCALAR; type <= wke::BLIT_KERNEL_AVX2; ++type)
+        printf("%10s", kernelName((wke::BlitKernelType)type));
+    printf("\n");
+
+    int mismatches = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i)
+    {
+        printf("%-14s", tests[i].name);
+
+        wke::initializeBlitKernels(wke::BLIT_KERNEL_SCALAR);
+        memset(expected, 0, frameBytes);
+        runFrames(tests[i].row, expected, src, 1);
+
+        for (int type = wke::BLIT_KERNEL_SCALAR; type <= wke::BLIT_KERNEL_AVX2; ++type)
+        {
+            if (wke::initializeBlitKernels((wke::BlitKernelType)type) != type)
+            {
+                printf("%10s", "-");
+                continue;
+            }
+
+            // Warm up the caches and the page tables before timing.
+            memset(dst, 0, frameBytes);
+            runFrames(tests[i].row, dst, src, 1);
+            if (memcmp(dst, expected, frameBytes))
+                ++mismatches;
+
+            printf("%10.2f", runFrames(tests[i].row, dst, src, frames));
+        }
+        printf("\n");
+    }
+
+    wke::initializeBlitKernels();
+
+    _aligned_free(expected);
+    _aligned_free(dst);
+    _aligned_free(src);
+
+    if (mismatches)
+    {
+        fprintf(stderr, "%d kernels differ from the scalar output\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
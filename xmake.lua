@@ -728,6 +728,7 @@ target("wtf")
         "MetaAllocator.cpp",
         "MD5.cpp",
         "NullPtr.cpp",
+        "NumberOfCores.cpp",
         "OSAllocatorWin.cpp",
         "OSRandomSource.cpp",
         "PageAllocationAligned.cpp",
@@ -905,7 +906,7 @@ target("JavaScriptCore")
         "runtime/Executable.cpp",
         "runtime/FunctionConstructor.cpp",
         "runtime/FunctionPrototype.cpp",
-        "runtime/GCActivityCallback.cpp",
+        "runtime/GCActivityCallbackWin.cpp",
         "runtime/GetterSetter.cpp",
         "runtime/Heuristics.cpp",
         "runtime/Identifier.cpp",
@@ -979,6 +980,7 @@ target("JavaScriptCore")
         "profiler/ProfileGenerator.cpp",
         "profiler/ProfileNode.cpp",
         "profiler/Profiler.cpp",
+        "profiler/SamplingProfiler.cpp",
         "bytecode/CodeBlock.cpp",
         "bytecode/JumpTable.cpp",
         "bytecode/Opcode.cpp",
@@ -1319,6 +1321,7 @@ local WEBCORE_SRC_FILES = {
     "WebCore/platform/cf/KURLCFNet.cpp",
     "WebCore/platform/cf/SharedBufferCF.cpp",
     "WebCore/platform/cf/win/CertificateCFWin.cpp",
+    "WebCore/platform/graphics/AsyncImageDecoder.cpp",
     "WebCore/platform/graphics/BitmapImage.cpp",
     "WebCore/platform/graphics/Color.cpp",
     "WebCore/platform/graphics/ContextShadow.cpp",
@@ -1465,6 +1468,8 @@ local WEBCORE_SRC_FILES = {
     "WebCore/platform/network/win/NetworkStateNotifierWin.cpp",
     "WebCore/platform/network/curl/CookieJarCurl.cpp",
     "WebCore/platform/network/curl/CredentialStorageCurl.cpp",
+    "WebCore/platform/network/curl/CurlCacheEntry.cpp",
+    "WebCore/platform/network/curl/CurlCacheManager.cpp",
     "WebCore/platform/network/curl/DNSCurl.cpp",
     "WebCore/platform/network/curl/FormDataStreamCurl.cpp",
     "WebCore/platform/network/curl/ProxyServerCurl.cpp",
@@ -1503,6 +1508,7 @@ local WEBCORE_SRC_FILES = {
     "WebCore/platform/text/TextEncodingRegistry.cpp",
     "WebCore/platform/text/TextStream.cpp",
     "WebCore/platform/text/UnicodeRange.cpp",
+    "WebCore/platform/graphics/WidthCache.cpp",
     "WebCore/platform/graphics/WidthIterator.cpp",
     "WebCore/platform/text/cf/HyphenationCF.cpp",
     "WebCore/platform/text/cf/StringCF.cpp",
@@ -2207,6 +2213,7 @@ target("wke")
         "setting_call.cpp",
         "jsBind.cpp",
         "wke.cpp",
+        "wkeBlit.cpp",
         "wkeChromeClient.cpp",
         "wkeContextMenuClient.cpp",
         "wkeDebug.cpp",
@@ -2314,6 +2321,18 @@ target("wkeBrowser")
         -- "rpcrt4",
         -- "advapi32",
 
+target("wkeBlitBench")
+    set_kind("binary")
+    add_cxxflags("/utf-8", {force = true})
+    add_deps("wke")
+    add_includedirs("./src/wke")
+    add_files("./src/wkeBlitBench/wkeBlitBench.cpp")
+    add_defines(
+        "WIN32",
+        "NDEBUG",
+        "_CONSOLE"
+    )
+
 target("test1")
     set_kind("binary")
     add_cxflags("/D UNICODE")
@@ -2381,6 +2400,16 @@ target("test1")
         "rpcrt4"
     )
 
+target("testJSONStringScan")
+    set_kind("binary")
+    add_cxxflags("/utf-8", {force = true})
+    add_includedirs("./src/JavaScriptCore")
+    add_includedirs("./src/JavaScriptCore/runtime")
+    add_includedirs("./3rd/include")
+    add_files("./src/JavaScriptCore/testJSONStringScan.cpp")
+    add_deps("wtf")
+    add_links("icu")
+
 target("test")
     set_kind("binary")
     add_cxxflags("/D UNICODE")